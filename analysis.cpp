@@ -0,0 +1,285 @@
+#include "analysis.h"
+
+#include "exceptions.h"
+#include "game_state.h"
+#include "position_corpus.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <sstream>
+
+using namespace std;
+
+// how many of the latest latencies of each type of request the percentiles are taken over
+static const size_t RECENT_LATENCIES = 1024;
+
+// the most moves a single request may ask for
+static const size_t MAX_MOVES = 1000;
+
+// the most words a single request may ask for
+static const size_t MAX_WORDS = 100000;
+
+// the longest word a request may ask for by length
+static const size_t MAX_WORD_LENGTH = 100;
+
+AnalysisService::AnalysisService(
+        const Dictionary& dictionary,
+        const Board& empty_board,
+        const TileCollection& distribution,
+        size_t hand_size,
+        shared_ptr<const LeaveTable> leaves)
+        : dictionary(dictionary),
+          empty_board(empty_board),
+          distribution(distribution),
+          hand_size(hand_size),
+          player("analysis", hand_size) {
+    player.set_leave_table(leaves);
+}
+
+string AnalysisService::handle(const string& request, chrono::steady_clock::time_point received) {
+    string id;
+    string type = "error";  // failed requests are counted together, whatever their type
+    string body;
+    try {
+        JsonValue parsed = JsonValue::parse(request);
+        if (parsed.has("id"))
+            id = parsed["id"].dump();
+        if (parsed.type() != JsonValue::Type::OBJECT || !parsed.has("type"))
+            throw JsonException("a request is an object with a type");
+        string requested = parsed["type"].as_string();
+        body = answer(requested, parsed);
+        type = requested;
+        body = "\"ok\":true," + body;
+    } catch (const exception& e) {
+        // JsonException, FileException from the position and MoveException from the move are all the client's
+        body = "\"ok\":false,\"error\":" + json_quote(e.what());
+    }
+
+    chrono::duration<double, micro> micros = chrono::steady_clock::now() - received;
+    record(type, micros.count());
+    ostringstream out;
+    out << "{";
+    if (!id.empty())
+        out << "\"id\":" << id << ",";
+    out << body << ",\"micros\":" << llround(micros.count()) << "}";
+    return out.str();
+}
+
+string AnalysisService::answer(const string& type, const JsonValue& request) {
+    if (type == "moves")
+        return moves(request);
+    if (type == "validate")
+        return validate(request);
+    if (type == "score")
+        return score(request);
+    if (type == "words")
+        return words(request);
+    if (type == "stats")
+        return stats();
+    throw JsonException("unknown request type " + type);
+}
+
+// A whole number from 1 to most, or fallback when the request does not have the member.
+static size_t read_count(const JsonValue& request, const string& name, size_t fallback, size_t most) {
+    if (!request.has(name))
+        return fallback;
+    double count = request[name].as_number();
+    if (count < 1 || count > most || count != floor(count))
+        throw JsonException(name + " must be a whole number from 1 to " + to_string(most));
+    return size_t(count);
+}
+
+string AnalysisService::moves(const JsonValue& request) const {
+    Board board = read_board(request);
+    TileCollection rack = PositionCorpus::parse_rack(request["rack"].as_string(), distribution);
+    size_t count = read_count(request, "count", 10, MAX_MOVES);
+
+    vector<ScoredMove> best = player.best_moves(board, dictionary, rack, count);
+    return "\"moves\":" + scored_moves_json(best);
+}
+
+string AnalysisService::words_json(const vector<string>& words) {
+    string out = "[";
+    for (size_t i = 0; i < words.size(); i++) {
+        out += (i > 0 ? "," : "") + json_quote(words[i]);
+    }
+    return out + "]";
+}
+
+string AnalysisService::validate(const JsonValue& request) const {
+    Board board = read_board(request);
+    Move move = read_move(request);
+
+    if (request.has("rack")) {
+        TileCollection rack = PositionCorpus::parse_rack(request["rack"].as_string(), distribution);
+        for (const TileKind& tile : move.tiles) {
+            if (rack.count_tiles(tile) == 0)
+                return "\"valid\":false,\"reason\":" + json_quote("the rack does not hold the tiles");
+            rack.remove_tile(tile);
+        }
+    }
+
+    PlaceResult result = board.test_place(move);
+    if (!result.valid)
+        return "\"valid\":false,\"reason\":" + json_quote(result.error);
+    for (const string& word : result.words) {
+        if (!dictionary.is_word(word))
+            return "\"valid\":false,\"reason\":" + json_quote(word + " is not a word") + ",\"words\":"
+                   + words_json(result.words);
+    }
+    unsigned int points = result.points + (move.tiles.size() == hand_size ? GameState::EMPTY_HAND_BONUS : 0);
+    return "\"valid\":true,\"points\":" + to_string(points) + ",\"words\":" + words_json(result.words);
+}
+
+string AnalysisService::score(const JsonValue& request) const {
+    Board board = read_board(request);
+    Move move = read_move(request);
+    PlaceResult result = board.test_place(move);
+    if (!result.valid)
+        throw MoveException(result.error);
+    unsigned int points = result.points + (move.tiles.size() == hand_size ? GameState::EMPTY_HAND_BONUS : 0);
+    return "\"points\":" + to_string(points) + ",\"words\":" + words_json(result.words);
+}
+
+string AnalysisService::words(const JsonValue& request) const {
+    WordQuery query;
+    if (request.has("pattern"))
+        query.pattern = request["pattern"].as_string();
+    if (request.has("contains"))
+        query.contains = request["contains"].as_string();
+    if (request.has("rack")) {
+        query.use_rack = true;
+        query.rack = request["rack"].as_string();
+    }
+    query.min_length = read_count(request, "min_length", 1, MAX_WORD_LENGTH);
+    query.max_length = read_count(request, "max_length", SIZE_MAX, MAX_WORD_LENGTH);
+    size_t limit = read_count(request, "limit", 100, MAX_WORDS);
+
+    vector<string> found;
+    bool truncated = false;
+    dictionary.search(query, [&](const string& word) {
+        if (found.size() == limit) {
+            truncated = true;
+            return false;
+        }
+        found.push_back(word);
+        return true;
+    });
+    return "\"words\":" + words_json(found) + ",\"truncated\":" + (truncated ? "true" : "false");
+}
+
+string AnalysisService::stats() {
+    lock_guard<mutex> lock(latencies_mutex);
+    ostringstream out;
+    out << "\"stats\":{";
+    bool first = true;
+    for (const pair<const string, Latencies>& entry : latencies) {
+        const Latencies& type = entry.second;
+        vector<double> sorted(type.recent);
+        sort(sorted.begin(), sorted.end());
+        auto percentile = [&](double p) { return sorted.empty() ? 0 : sorted[size_t(p * (sorted.size() - 1))]; };
+        out << (first ? "" : ",") << json_quote(entry.first) << ":{\"count\":" << type.count
+            << ",\"mean_micros\":" << llround(type.total_micros / type.count)
+            << ",\"p50_micros\":" << llround(percentile(0.5)) << ",\"p99_micros\":" << llround(percentile(0.99))
+            << ",\"max_micros\":" << llround(type.max_micros) << "}";
+        first = false;
+    }
+    out << "}";
+    return out.str();
+}
+
+Board AnalysisService::read_board(const JsonValue& request) const {
+    if (!request.has("board"))
+        return empty_board;
+    vector<string> rows;
+    for (const JsonValue& row : request["board"].as_array()) {
+        rows.push_back(row.as_string());
+    }
+    return PositionCorpus::parse_board(rows, empty_board, distribution);
+}
+
+Move AnalysisService::read_move(const JsonValue& request) const {
+    Move move = parse_move(request["move"], empty_board, distribution, hand_size);
+    if (move.kind != MoveKind::PLACE)
+        throw MoveException("only a move that places tiles can be checked");
+    return move;
+}
+
+Move AnalysisService::parse_move(
+        const JsonValue& move, const Board& board, const TileCollection& distribution, size_t hand_size) {
+    string kind = move.has("kind") ? move["kind"].as_string() : "place";
+    if (kind == "pass")
+        return Move();
+    if (kind == "exchange") {
+        TileCollection rack = PositionCorpus::parse_rack(move["tiles"].as_string(), distribution);
+        if (rack.count_tiles() == 0 || rack.count_tiles() > hand_size)
+            throw MoveException("an exchange swaps from 1 to " + to_string(hand_size) + " tiles");
+        return Move(vector<TileKind>(rack.cbegin(), rack.cend()));
+    }
+    if (kind != "place")
+        throw MoveException("the kind of a move is place, pass or exchange");
+
+    double row = move["row"].as_number();
+    double column = move["column"].as_number();
+    if (row < 0 || column < 0 || row >= board.rows || column >= board.columns || row != floor(row)
+        || column != floor(column))
+        throw MoveException("the move does not start on the board");
+
+    string direction = move["direction"].as_string();
+    if (direction != "across" && direction != "down")
+        throw MoveException("the direction of a move is across or down");
+    string letters = move["tiles"].as_string();
+    if (letters.empty() || letters.size() > hand_size)
+        throw MoveException("a move places from 1 to " + to_string(hand_size) + " tiles");
+
+    vector<TileKind> tiles;
+    for (char letter : letters) {
+        tiles.push_back(PositionCorpus::parse_tile(letter, distribution));
+    }
+    return Move(tiles, size_t(row), size_t(column), direction == "across" ? Direction::ACROSS : Direction::DOWN);
+}
+
+string AnalysisService::move_json(const Move& move) {
+    if (move.kind == MoveKind::PASS)
+        return "{\"kind\":\"pass\"}";
+    if (move.kind == MoveKind::EXCHANGE) {
+        // exchanged blanks stand for no letter, so they are written as they are on a rack
+        TileCollection exchanged;
+        for (const TileKind& tile : move.tiles) {
+            exchanged.add_tile(tile);
+        }
+        return "{\"kind\":\"exchange\",\"tiles\":" + json_quote(PositionCorpus::format_rack(exchanged)) + "}";
+    }
+    string tiles;
+    for (const TileKind& tile : move.tiles) {
+        tiles += PositionCorpus::format_tile(tile);
+    }
+    return "{\"row\":" + to_string(move.row) + ",\"column\":" + to_string(move.column) + ",\"direction\":"
+           + (move.direction == Direction::DOWN ? "\"down\"" : "\"across\"") + ",\"tiles\":" + json_quote(tiles)
+           + "}";
+}
+
+string AnalysisService::scored_moves_json(const vector<ScoredMove>& moves) {
+    ostringstream out;
+    out << "[";
+    for (size_t i = 0; i < moves.size(); i++) {
+        string move = move_json(moves[i].move);
+        move.pop_back();  // the closing brace, to add the points and equity
+        out << (i > 0 ? "," : "") << move << ",\"points\":" << moves[i].points << ",\"equity\":" << moves[i].equity
+            << "}";
+    }
+    out << "]";
+    return out.str();
+}
+
+void AnalysisService::record(const string& type, double micros) {
+    lock_guard<mutex> lock(latencies_mutex);
+    Latencies& entry = latencies[type];
+    if (entry.recent.size() < RECENT_LATENCIES)
+        entry.recent.push_back(micros);
+    else
+        entry.recent[entry.count % RECENT_LATENCIES] = micros;
+    entry.count++;
+    entry.total_micros += micros;
+    entry.max_micros = max(entry.max_micros, micros);
+}
@@ -0,0 +1,98 @@
+#ifndef ANALYSIS_H
+#define ANALYSIS_H
+
+#include "board.h"
+#include "computer_player.h"
+#include "dictionary.h"
+#include "json.h"
+#include "leave_table.h"
+#include "move_sink.h"
+#include "tile_collection.h"
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+Answers analysis requests, one JSON object per line, against a lexicon, board and bag that are loaded once. Any
+number of threads may call handle at the same time: requests only read the shared state, and the latency statistics
+are kept behind a lock.
+
+    {"id": 1, "type": "moves", "board": [rows], "rack": "AEIRST?", "count": 10}
+    {"id": 2, "type": "validate", "board": [rows], "move": {"row": 7, "column": 5, "direction": "across",
+     "tiles": "WoRD"}, "rack": "DORW?"}
+    {"id": 3, "type": "score", "board": [rows], "move": {...}}
+    {"id": 4, "type": "words", "pattern": "?a??ing", "contains": "z", "rack": "AEIRST?", "limit": 100}
+    {"id": 5, "type": "stats"}
+
+moves answers the best count moves by equity, validate whether a move is legal and forms only words (on the rack when
+one is given), and score what a legal placement scores whether or not its words are in the dictionary. words answers
+up to limit words in alphabetical order matching a WordQuery, whose parts are all optional (min_length and max_length
+too), and whether there were more. stats answers the number and latency of the requests answered so far, by type.
+
+Boards are lists of rows in the position corpus format, and an absent board is the empty one. Moves have zero based
+rows and columns and list only the tiles they place, with lower case letters for blanks. Every response is one line
+with the request's id, "ok", and either the answer or an "error", and "micros", the time from the request arriving to
+its answer being ready.
+*/
+class AnalysisService {
+public:
+    AnalysisService(
+            const Dictionary& dictionary,
+            const Board& empty_board,
+            const TileCollection& distribution,
+            size_t hand_size,
+            std::shared_ptr<const LeaveTable> leaves);
+
+    // Never throws: a request that cannot be answered gets a response with an error.
+    std::string handle(const std::string& request, std::chrono::steady_clock::time_point received);
+
+    // A move as a JSON object, in the notation requests use.
+    static std::string move_json(const Move& move);
+
+    // Moves as a JSON array of move objects with their points and equity added.
+    static std::string scored_moves_json(const std::vector<ScoredMove>& moves);
+
+    /*
+    Reads a move in the notation move_json writes, passes and exchanges included. Throws a MoveException if it does not
+    start on board or places more than hand_size tiles, and a FileException for a tile not in the distribution.
+    */
+    static Move parse_move(
+            const JsonValue& move, const Board& board, const TileCollection& distribution, size_t hand_size);
+
+    // Strings as a JSON array.
+    static std::string words_json(const std::vector<std::string>& words);
+
+private:
+    // the latencies of one type of request; only the most recent ones are kept for the percentiles
+    struct Latencies {
+        size_t count = 0;
+        double total_micros = 0;
+        double max_micros = 0;
+        std::vector<double> recent;
+    };
+
+    const Dictionary& dictionary;
+    const Board& empty_board;
+    TileCollection distribution;
+    size_t hand_size;
+    ComputerPlayer player;
+
+    std::mutex latencies_mutex;
+    std::map<std::string, Latencies> latencies;
+
+    std::string answer(const std::string& type, const JsonValue& request);
+    std::string moves(const JsonValue& request) const;
+    std::string validate(const JsonValue& request) const;
+    std::string score(const JsonValue& request) const;
+    std::string words(const JsonValue& request) const;
+    std::string stats();
+
+    Board read_board(const JsonValue& request) const;
+    Move read_move(const JsonValue& request) const;
+    void record(const std::string& type, double micros);
+};
+
+#endif
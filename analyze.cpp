@@ -0,0 +1,211 @@
+#include "analysis.h"
+#include "exceptions.h"
+#include "position_corpus.h"
+#include "scrabble_config.h"
+#include "thread_pool.h"
+#include "tile_bag.h"
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+struct AnalyzeOptions {
+    string config_path;
+    string positions_path;  // "-" for stdin
+    string out_path;  // stdout when empty
+    size_t count = 1;  // moves per position
+    size_t threads = 0;  // one per hardware thread
+    size_t window = 0;  // positions in flight at once; four per thread when zero
+};
+
+/*
+The results of the positions in flight, kept in a ring of window slots: position i goes into slot i % window, and is
+written once every position before it has been. Reading waits for a free slot, so at most window positions and their
+results are held at once, however long the input is.
+*/
+class OrderedResults {
+public:
+    explicit OrderedResults(size_t window) : slots(window), ready(window, false) {}
+
+    // Waits until position index has a free slot, writing out every result that is ready in order meanwhile.
+    void wait_for_slot(size_t index, ostream& out) {
+        unique_lock<mutex> lock(slots_mutex);
+        while (true) {
+            write_ready(out, lock);
+            if (index - written < slots.size())
+                return;
+            result_ready.wait(lock);
+        }
+    }
+
+    void put(size_t index, string result) {
+        lock_guard<mutex> lock(slots_mutex);
+        slots[index % slots.size()] = move(result);
+        ready[index % slots.size()] = true;
+        result_ready.notify_one();
+    }
+
+    // Waits for and writes every result up to count.
+    void finish(size_t count, ostream& out) {
+        unique_lock<mutex> lock(slots_mutex);
+        while (true) {
+            write_ready(out, lock);
+            if (written == count)
+                return;
+            result_ready.wait(lock);
+        }
+    }
+
+private:
+    vector<string> slots;
+    vector<bool> ready;
+    size_t written = 0;
+    mutex slots_mutex;
+    condition_variable result_ready;
+
+    // the lock is let go while writing, so that workers can keep handing in results
+    void write_ready(ostream& out, unique_lock<mutex>& lock) {
+        while (ready[written % slots.size()]) {
+            size_t slot = written % slots.size();
+            string result = move(slots[slot]);
+            ready[slot] = false;
+            lock.unlock();
+            out << result << '\n';
+            lock.lock();
+            written++;
+        }
+    }
+};
+
+void print_usage(const char* program) {
+    cerr << "Usage: " << program << " <configuration file> <positions file or -> [--count N] [--threads N]"
+         << " [--window N] [--out FILE]" << endl;
+    cerr << "Writes the best moves of every position of a corpus as a JSON line, in the order of the input." << endl;
+}
+
+// Reads the command line into options. Returns false if it is malformed.
+bool parse_options(int argc, char** argv, AnalyzeOptions& options) {
+    if (argc < 3) {
+        return false;
+    }
+    options.config_path = argv[1];
+    options.positions_path = argv[2];
+    for (int i = 3; i < argc; i += 2) {
+        if (i + 1 >= argc) {
+            return false;
+        }
+        string flag = argv[i];
+        string value = argv[i + 1];
+        if (flag == "--count") {
+            options.count = stoul(value);
+        } else if (flag == "--threads") {
+            options.threads = stoul(value);
+        } else if (flag == "--window") {
+            options.window = stoul(value);
+        } else if (flag == "--out") {
+            options.out_path = value;
+        } else {
+            return false;
+        }
+    }
+    return options.count > 0;
+}
+
+/*
+Streams the positions of a corpus to a pool of workers and writes the best moves of each as they are found, in input
+order. Every worker only reads the shared dictionary and leave table, so the pool keeps every core busy, while the
+window of positions in flight keeps memory bounded.
+*/
+void analyze(
+        const AnalyzeOptions& options,
+        istream& in,
+        ostream& out,
+        const Dictionary& dictionary,
+        const Board& empty_board,
+        const TileCollection& distribution,
+        const ComputerPlayer& player) {
+    // the results outlive the pool, whose workers may still be leaving put when the last result is written
+    size_t threads = options.threads == 0 ? ThreadPool::hardware_threads() : options.threads;
+    OrderedResults results(options.window > 0 ? options.window : 4 * threads);
+    ThreadPool pool(threads);
+
+    size_t index = 0;
+    CorpusPosition position{"", empty_board, TileCollection()};
+    try {
+        for (; PositionCorpus::read_next(in, empty_board, distribution, position); index++) {
+            results.wait_for_slot(index, out);
+            pool.submit([&results, &dictionary, &player, &options, position, index] {
+                chrono::steady_clock::time_point start = chrono::steady_clock::now();
+                vector<ScoredMove> best = player.best_moves(position.board, dictionary, position.rack, options.count);
+                chrono::duration<double, micro> micros = chrono::steady_clock::now() - start;
+                results.put(
+                        index,
+                        "{\"name\":" + json_quote(position.name)
+                                + ",\"moves\":" + AnalysisService::scored_moves_json(best)
+                                + ",\"micros\":" + to_string(llround(micros.count())) + "}");
+            });
+        }
+    } catch (const FileException& e) {
+        // the positions before the bad one are still written
+        results.finish(index, out);
+        throw;
+    }
+    results.finish(index, out);
+}
+
+// Annotates a file of positions, or stdin, with the engine's best moves.
+int main(int argc, char** argv) {
+    AnalyzeOptions options;
+    try {
+        if (!parse_options(argc, argv, options)) {
+            print_usage(argv[0]);
+            return 1;
+        }
+    } catch (const logic_error& e) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    try {
+        ScrabbleConfig config = ScrabbleConfig::read(options.config_path);
+        const Dictionary dictionary = Dictionary::read(config.dictionary_file_path);
+        const Board board = Board::read(config.board_file_path);
+        const TileBag tile_bag = TileBag::read(config.tile_bag_file_path, config.seed);
+        ComputerPlayer player("analyze", config.hand_size);
+        if (!config.leave_file_path.empty()) {
+            player.set_leave_table(make_shared<LeaveTable>(LeaveTable::read(config.leave_file_path)));
+        }
+
+        ifstream file;
+        if (options.positions_path != "-") {
+            file.open(options.positions_path);
+            if (!file) {
+                throw FileException("cannot open positions file " + options.positions_path);
+            }
+        }
+        istream& in = options.positions_path == "-" ? cin : file;
+
+        ofstream out_file;
+        if (!options.out_path.empty()) {
+            out_file.open(options.out_path);
+            if (!out_file) {
+                throw FileException("cannot open output file " + options.out_path);
+            }
+        }
+        ostream& out = options.out_path.empty() ? cout : out_file;
+
+        analyze(options, in, out, dictionary, board, tile_bag.to_collection(), player);
+    } catch (const FileException& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
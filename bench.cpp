@@ -0,0 +1,530 @@
+#include "board.h"
+#include "computer_player.h"
+#include "dictionary.h"
+#include "exceptions.h"
+#include "game_state.h"
+#include "position_corpus.h"
+#include "rack_index.h"
+#include "scrabble_config.h"
+#include "thread_pool.h"
+#include "tile_bag.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <sys/resource.h>
+#include <vector>
+
+using namespace std;
+
+// results are added up here so that the compiler cannot drop the work being timed
+static volatile uint64_t sink = 0;
+
+struct BenchOptions {
+    chrono::milliseconds min_time{500};
+    string filter;  // only benchmarks whose names contain this are run
+    string out_path;
+    string corpus_path;  // positions to time moves on, instead of those of two greedy games
+    size_t repeat = 1;  // how many times each benchmark is timed, for its median and confidence interval
+    string baseline_path;  // earlier output to compare against
+    string thresholds_path;  // how much slower or larger than the baseline each measurement may get
+};
+
+struct Benchmark {
+    string name;
+    // does some work and returns how many operations it did; checksum is set from what the work produced
+    function<size_t(uint64_t& checksum)> run;
+};
+
+struct BenchmarkResult {
+    string name;
+    size_t runs = 0;
+    size_t operations = 0;
+    double seconds = 0;
+    uint64_t checksum = 0;
+    vector<double> samples;  // the nanoseconds per operation of each repetition
+    double ns_per_op = 0;  // the median of the samples
+    double ns_per_op_low = 0;  // the 95% confidence interval of the median
+    double ns_per_op_high = 0;
+};
+
+// What an earlier run measured, read back from its JSON output.
+struct Baseline {
+    map<string, BenchmarkResult> results;
+    double peak_rss_kb = 0;
+};
+
+// A position from a fixed self-played game or a corpus: the board before a move and the rack of the player to move.
+struct BenchPosition {
+    Board board;
+    shared_ptr<ComputerPlayer> player;  // a copy of the player to move, holding its rack
+};
+
+void print_usage(const char* program) {
+    cerr << "Usage: " << program << " <configuration file> [--min-ms N] [--filter TEXT] [--out FILE]"
+         << " [--corpus FILE] [--repeat N] [--baseline FILE] [--thresholds FILE]" << endl;
+    cerr << "With a baseline and thresholds, exits with 2 if a measurement regressed beyond its threshold." << endl;
+}
+
+bool parse_options(int argc, char** argv, BenchOptions& options) {
+    for (int i = 2; i < argc; i += 2) {
+        string flag = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        string value = argv[i + 1];
+        if (flag == "--min-ms") {
+            options.min_time = chrono::milliseconds(stoul(value));
+        } else if (flag == "--filter") {
+            options.filter = value;
+        } else if (flag == "--out") {
+            options.out_path = value;
+        } else if (flag == "--corpus") {
+            options.corpus_path = value;
+        } else if (flag == "--repeat") {
+            options.repeat = max<size_t>(stoul(value), 1);
+        } else if (flag == "--baseline") {
+            options.baseline_path = value;
+        } else if (flag == "--thresholds") {
+            options.thresholds_path = value;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+Sets the median of the samples and a 95% confidence interval for it. The interval is the pair of order statistics
+that bracket the median with 95% probability whatever the distribution of the samples, which suits timings with their
+long tail of slow runs. Below six samples no such pair exists, and the interval is the whole range.
+*/
+void summarize(BenchmarkResult& result) {
+    vector<double> sorted(result.samples);
+    sort(sorted.begin(), sorted.end());
+    size_t n = sorted.size();
+    result.ns_per_op = n % 2 == 1 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+    double half_width = 0.98 * sqrt(double(n));
+    size_t low = size_t(max(floor(n / 2.0 - half_width), 0.0));
+    size_t high = size_t(min(ceil(n / 2.0 + half_width), double(n - 1)));
+    result.ns_per_op_low = n < 6 ? sorted.front() : sorted[low];
+    result.ns_per_op_high = n < 6 ? sorted.back() : sorted[high];
+}
+
+/*
+Times a benchmark repeat times. Each repetition runs it until at least min_time has passed, and at least once, and
+gives one sample. The checksum of the first run is kept, so that a change in what the benchmark computes shows up
+next to the change in its speed.
+*/
+BenchmarkResult run_benchmark(const Benchmark& benchmark, chrono::milliseconds min_time, size_t repeat) {
+    BenchmarkResult result;
+    result.name = benchmark.name;
+    for (size_t r = 0; r < repeat; r++) {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        chrono::duration<double> elapsed(0);
+        size_t operations = 0;
+        do {
+            uint64_t checksum = 0;
+            operations += benchmark.run(checksum);
+            sink += checksum;
+            if (result.runs++ == 0) {
+                result.checksum = checksum;
+            }
+            elapsed = chrono::steady_clock::now() - start;
+        } while (elapsed < min_time);
+        result.operations += operations;
+        result.seconds += elapsed.count();
+        result.samples.push_back(operations > 0 ? elapsed.count() * 1e9 / operations : 0);
+    }
+    summarize(result);
+    return result;
+}
+
+// The largest the process has been, in kilobytes.
+double peak_rss_kb() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/*
+Writes the results as JSON with one benchmark per line, always in the same order and with the same fields, so that
+the output of two commits can be compared with diff, and so that read_baseline can read it back line by line.
+*/
+void write_json(ostream& out, const vector<BenchmarkResult>& results, double peak_rss) {
+    out << "{\n  \"peak_rss_kb\": " << fixed << setprecision(0) << peak_rss << ",\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchmarkResult& result = results[i];
+        out << "    {\"name\": \"" << result.name << "\", \"runs\": " << result.runs
+            << ", \"operations\": " << result.operations << ", \"seconds\": " << setprecision(6) << result.seconds
+            << ", \"ns_per_op\": " << setprecision(1) << result.ns_per_op << ", \"ns_per_op_low\": "
+            << result.ns_per_op_low << ", \"ns_per_op_high\": " << result.ns_per_op_high
+            << ", \"checksum\": " << result.checksum << "}" << (i + 1 < results.size() ? "," : "") << '\n';
+    }
+    out << "  ]\n}\n";
+}
+
+// The number after "key": on a line of write_json's output, or -1 if the line has no such key.
+double json_number(const string& line, const string& key) {
+    size_t at = line.find("\"" + key + "\": ");
+    return at == string::npos ? -1 : stod(line.substr(at + key.size() + 4));
+}
+
+// Reads the output of an earlier run. Only the layout write_json writes is understood, not JSON in general.
+Baseline read_baseline(const string& path) {
+    ifstream file(path);
+    if (!file) {
+        throw FileException("cannot open baseline file " + path);
+    }
+    Baseline baseline;
+    string line;
+    while (getline(file, line)) {
+        if (line.find("\"peak_rss_kb\": ") != string::npos) {
+            baseline.peak_rss_kb = json_number(line, "peak_rss_kb");
+        }
+        size_t name = line.find("\"name\": \"");
+        if (name == string::npos) {
+            continue;
+        }
+        BenchmarkResult result;
+        result.name = line.substr(name + 9, line.find('"', name + 9) - (name + 9));
+        result.ns_per_op = json_number(line, "ns_per_op");
+        result.ns_per_op_low = json_number(line, "ns_per_op_low");
+        result.ns_per_op_high = json_number(line, "ns_per_op_high");
+        if (result.ns_per_op < 0 || result.ns_per_op_low < 0 || result.ns_per_op_high < 0) {
+            throw FileException("baseline benchmark " + result.name + " has no timings");
+        }
+        baseline.results[result.name] = result;
+    }
+    return baseline;
+}
+
+/*
+Reads thresholds in the "key: value" layout of the configuration file: a benchmark name, or peak_rss_kb, and the
+fraction it may grow by, such as 0.10 for ten percent. Lines starting with '#' are comments.
+*/
+map<string, double> read_thresholds(const string& path) {
+    ifstream file(path);
+    if (!file) {
+        throw FileException("cannot open thresholds file " + path);
+    }
+    map<string, double> thresholds;
+    string line;
+    while (getline(file, line)) {
+        size_t colon = line.find(':');
+        if (line.empty() || line[0] == '#' || colon == string::npos) {
+            continue;
+        }
+        try {
+            thresholds[line.substr(0, colon)] = stod(line.substr(colon + 1));
+        } catch (const logic_error& e) {
+            throw FileException("threshold for " + line.substr(0, colon) + " is not a number");
+        }
+    }
+    return thresholds;
+}
+
+/*
+Prints one line per threshold comparing this run with the baseline, and returns whether anything regressed. A
+benchmark regressed when its median grew by more than its threshold. The confidence intervals are printed to judge the
+noise by, but not required to be apart: with few samples they cover nearly every sample and would hide real
+regressions. Peak memory is compared directly.
+*/
+bool compare(
+        ostream& out,
+        const vector<BenchmarkResult>& results,
+        double peak_rss,
+        const Baseline& baseline,
+        const map<string, double>& thresholds) {
+    bool regressed = false;
+    out << fixed << setprecision(1);
+    for (const pair<const string, double>& threshold : thresholds) {
+        const string& name = threshold.first;
+        out << name << ": ";
+        if (name == "peak_rss_kb") {
+            double change = baseline.peak_rss_kb > 0 ? peak_rss / baseline.peak_rss_kb - 1 : 0;
+            bool worse = change > threshold.second;
+            regressed |= worse;
+            out << peak_rss << " kB, baseline " << baseline.peak_rss_kb << " kB, " << showpos << change * 100
+                << noshowpos << "%, threshold " << threshold.second * 100 << "%: " << (worse ? "REGRESSED" : "ok")
+                << '\n';
+            continue;
+        }
+
+        vector<BenchmarkResult>::const_iterator result = find_if(
+                results.begin(), results.end(), [&](const BenchmarkResult& r) { return r.name == name; });
+        map<string, BenchmarkResult>::const_iterator base = baseline.results.find(name);
+        if (result == results.end()) {
+            out << "not run\n";
+            continue;
+        }
+        if (base == baseline.results.end()) {
+            out << "not in the baseline\n";
+            continue;
+        }
+        double change = base->second.ns_per_op > 0 ? result->ns_per_op / base->second.ns_per_op - 1 : 0;
+        bool worse = change > threshold.second;
+        regressed |= worse;
+        out << result->ns_per_op << " ns/op [" << result->ns_per_op_low << ", " << result->ns_per_op_high
+            << "], baseline " << base->second.ns_per_op << " [" << base->second.ns_per_op_low << ", "
+            << base->second.ns_per_op_high << "], " << showpos << change * 100 << noshowpos << "%, threshold "
+            << threshold.second * 100 << "%: " << (worse ? "REGRESSED" : "ok") << '\n';
+    }
+    return regressed;
+}
+
+// Plays a game between two greedy players from a fixed seed and keeps the position before every move.
+vector<BenchPosition> play_positions(
+        const Board& start, const TileBag& tile_bag, const Dictionary& dictionary, size_t hand_size, uint64_t seed) {
+    vector<BenchPosition> positions;
+    TileBag bag(tile_bag);
+    bag.reseed(seed);
+    GameState game(start, bag, dictionary, hand_size);
+    vector<shared_ptr<ComputerPlayer>> players;
+    for (size_t p = 0; p < 2; p++) {
+        players.push_back(make_shared<ComputerPlayer>("bench", hand_size));
+        game.add_player(players.back());
+    }
+
+    while (!game.is_over()) {
+        // a copy, so that the position keeps the rack the player had
+        ComputerPlayer player(*players[game.current_player_index()]);
+        positions.push_back(BenchPosition{game.get_board(), make_shared<ComputerPlayer>(player)});
+        game.step();
+    }
+    return positions;
+}
+
+// Times the dictionary, the board, the bag, rack indexing and move generation over fixed positions.
+int main(int argc, char** argv) {
+    BenchOptions options;
+    if (argc < 2 || !parse_options(argc, argv, options)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    try {
+        ScrabbleConfig config = ScrabbleConfig::read(argv[1]);
+        Dictionary dictionary = Dictionary::read(config.dictionary_file_path);
+        Board start = Board::read(config.board_file_path);
+        TileBag tile_bag = TileBag::read(config.tile_bag_file_path, config.seed);
+        RackIndex racks(tile_bag.to_collection(), config.hand_size);
+
+        // every 50th word of the dictionary, and the same words reversed, most of which are not words
+        vector<string> words;
+        ifstream word_file(config.dictionary_file_path);
+        string word;
+        for (size_t i = 0; word_file >> word; i++) {
+            if (i % 50 == 0) {
+                words.push_back(word);
+                words.push_back(string(word.rbegin(), word.rend()));
+            }
+        }
+
+        // the positions of two games or of a corpus, and the best fifty moves in each of them
+        vector<BenchPosition> positions;
+        if (options.corpus_path.empty()) {
+            for (uint64_t game = 0; game < 2; game++) {
+                vector<BenchPosition> played = play_positions(
+                        start, tile_bag, dictionary, config.hand_size, Rng::derive_seed(config.seed, game));
+                positions.insert(positions.end(), played.begin(), played.end());
+            }
+        } else {
+            for (const CorpusPosition& position :
+                 PositionCorpus::read(options.corpus_path, start, tile_bag.to_collection())) {
+                shared_ptr<ComputerPlayer> player = make_shared<ComputerPlayer>("bench", config.hand_size);
+                for (TileCollection::const_iterator it = position.rack.cbegin(); it != position.rack.cend(); it++) {
+                    player->add_tiles({*it});
+                }
+                positions.push_back(BenchPosition{position.board, player});
+            }
+        }
+        vector<pair<size_t, Move>> candidates;
+        for (size_t i = 0; i < positions.size(); i++) {
+            const BenchPosition& position = positions[i];
+            for (const ScoredMove& scored :
+                 position.player->best_moves(position.board, dictionary, position.player->get_tiles(), 50)) {
+                candidates.emplace_back(i, scored.move);
+            }
+        }
+
+        // racks drawn like the racks of a game, as collections and as letter counts
+        vector<TileCollection> drawn;
+        vector<vector<uint8_t>> drawn_counts;
+        vector<uint32_t> indices;
+        for (size_t i = 0; i < 1000; i++) {
+            TileBag bag(tile_bag);
+            bag.reseed(Rng::derive_seed(config.seed, i));
+            TileCollection rack;
+            for (const TileKind& tile : bag.remove_random_tiles(config.hand_size)) {
+                rack.add_tile(tile);
+            }
+            drawn.push_back(rack);
+            indices.push_back(racks.rank(rack));
+            drawn_counts.emplace_back(racks.letters());
+            racks.unrank(indices.back(), drawn_counts.back().data());
+        }
+        vector<uint8_t> counts(racks.letters());
+
+        // the words each of the first racks can make, and those fitting a line with two letters fixed on it
+        vector<WordQuery> word_queries;
+        for (size_t i = 0; i < 100; i++) {
+            WordQuery query;
+            query.use_rack = true;
+            for (TileCollection::const_iterator it = drawn[i].cbegin(); it != drawn[i].cend(); it++) {
+                query.rack += it->letter;
+            }
+            if (i % 2 == 1)
+                query.pattern = "??e??s?";
+            word_queries.push_back(query);
+        }
+        ThreadPool pool;
+
+        vector<Benchmark> benchmarks = {
+                {"dictionary_read",
+                 [&](uint64_t& checksum) {
+                     Dictionary read = Dictionary::read(config.dictionary_file_path);
+                     checksum = read.get_root()->nexts.size();
+                     return size_t(1);
+                 }},
+                {"dictionary_is_word",
+                 [&](uint64_t& checksum) {
+                     for (const string& word : words) {
+                         checksum += dictionary.is_word(word);
+                     }
+                     return words.size();
+                 }},
+                {"dictionary_find_prefix",
+                 [&](uint64_t& checksum) {
+                     for (const string& word : words) {
+                         checksum += dictionary.find_prefix(word.substr(0, (word.size() + 1) / 2)) != nullptr;
+                     }
+                     return words.size();
+                 }},
+                {"dictionary_search",
+                 [&](uint64_t& checksum) {
+                     for (const WordQuery& query : word_queries) {
+                         dictionary.search(query, [&](const string& word) {
+                             checksum += word.size();
+                             return true;
+                         });
+                     }
+                     return word_queries.size();
+                 }},
+                {"dictionary_search_parallel",
+                 [&](uint64_t& checksum) {
+                     for (const WordQuery& query : word_queries) {
+                         dictionary.search(query, pool, [&](const string& word) {
+                             checksum += word.size();
+                             return true;
+                         });
+                     }
+                     return word_queries.size();
+                 }},
+                {"board_get_anchors",
+                 [&](uint64_t& checksum) {
+                     for (const BenchPosition& position : positions) {
+                         checksum += position.board.get_anchors().size();
+                     }
+                     return positions.size();
+                 }},
+                {"board_test_place",
+                 [&](uint64_t& checksum) {
+                     for (const pair<size_t, Move>& candidate : candidates) {
+                         PlaceResult result = positions[candidate.first].board.test_place(candidate.second);
+                         checksum += result.valid ? result.points : 0;
+                     }
+                     return candidates.size();
+                 }},
+                {"tile_bag_remove_random_tiles",
+                 [&](uint64_t& checksum) {
+                     // a whole bag is drawn a rack at a time, as in a game
+                     TileBag bag(tile_bag);
+                     size_t draws = 0;
+                     while (bag.count_tiles() > 0) {
+                         vector<TileKind> tiles = bag.remove_random_tiles(min(config.hand_size, bag.count_tiles()));
+                         checksum = checksum * 31 + tiles[0].letter;
+                         draws++;
+                     }
+                     return draws;
+                 }},
+                {"computer_player_get_move",
+                 [&](uint64_t& checksum) {
+                     for (const BenchPosition& position : positions) {
+                         Move move = position.player->get_move(position.board, dictionary);
+                         PlaceResult result = position.board.test_place(move);
+                         checksum += move.kind == MoveKind::PLACE && result.valid ? result.points : 0;
+                     }
+                     return positions.size();
+                 }},
+                {"rack_rank_collection",
+                 [&](uint64_t& checksum) {
+                     for (const TileCollection& rack : drawn) {
+                         checksum += racks.rank(rack);
+                     }
+                     return drawn.size();
+                 }},
+                {"rack_rank_counts",
+                 [&](uint64_t& checksum) {
+                     for (const vector<uint8_t>& rack : drawn_counts) {
+                         checksum += racks.rank(rack.data());
+                     }
+                     return drawn_counts.size();
+                 }},
+                {"rack_unrank_counts",
+                 [&](uint64_t& checksum) {
+                     for (uint32_t index : indices) {
+                         racks.unrank(index, counts.data());
+                         checksum = checksum * 31 + counts[0];
+                     }
+                     return indices.size();
+                 }},
+                {"rack_iterate_hand_size",
+                 [&](uint64_t& checksum) {
+                     racks.for_each(config.hand_size, [&](uint32_t index, const uint8_t* counts) {
+                         checksum += index ^ counts[0];
+                     });
+                     return size_t(racks.count(config.hand_size));
+                 }},
+        };
+
+        vector<BenchmarkResult> results;
+        for (const Benchmark& benchmark : benchmarks) {
+            if (benchmark.name.find(options.filter) == string::npos) {
+                continue;
+            }
+            results.push_back(run_benchmark(benchmark, options.min_time, options.repeat));
+        }
+        double peak_rss = peak_rss_kb();
+
+        if (options.out_path.empty()) {
+            write_json(cout, results, peak_rss);
+        } else {
+            ofstream out(options.out_path);
+            if (!out) {
+                throw FileException("cannot open " + options.out_path);
+            }
+            write_json(out, results, peak_rss);
+        }
+
+        // the report goes to standard error, leaving standard output to the JSON
+        if (!options.baseline_path.empty() && !options.thresholds_path.empty()) {
+            Baseline baseline = read_baseline(options.baseline_path);
+            map<string, double> thresholds = read_thresholds(options.thresholds_path);
+            if (compare(cerr, results, peak_rss, baseline, thresholds)) {
+                cerr << "performance regressed against " << options.baseline_path << endl;
+                return 2;
+            }
+        }
+        return 0;
+    } catch (const FileException& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+}
@@ -2,9 +2,8 @@
 
 #include "board_square.h"
 #include "exceptions.h"
-#include "formatting.h"
+#include <algorithm>
 #include <fstream>
-#include <iomanip>
 
 using namespace std;
 char Board::letter_at(Position p) const {
@@ -13,6 +12,10 @@ char Board::letter_at(Position p) const {
     return at(p).get_tile_kind().letter;
 }
 
+TileKind Board::tile_at(Position p) const { return at(p).get_tile_kind(); }
+
+const BoardSquare& Board::square_at(Position p) const { return at(p); }
+
 bool Board::Position::operator==(const Board::Position& other) const {
     return this->row == other.row && this->column == other.column;
 }
@@ -132,8 +135,8 @@ PlaceResult Board::test_place(const Move& move) const {
     // We create a variable for the direction that the word is going (the tiles will be placed),
     // and an antidirection for checking the words that can be created to the sides of each
     // tile placed. Based on the inputted direction, we infer the antidirection.
-    Direction dir;
-    Direction antidir;
+    Direction dir = Direction::NONE;
+    Direction antidir = Direction::NONE;
     switch (move.direction) {
     case Direction::ACROSS:
         dir = Direction::ACROSS;
@@ -243,6 +246,11 @@ PlaceResult Board::test_place(const Move& move) const {
             curr = curr.translate(dir);
         }
 
+        // Skipping over existing tiles may have taken us off the board.
+        if (!is_in_bounds(curr)) {
+            return PlaceResult("Move must be in bounds");
+        }
+
         // At each location, we want to add the current next tile into our
         // main word and add the points to our main points.
         if (move.tiles[i].letter == TileKind::BLANK_LETTER) {
@@ -390,7 +398,7 @@ PlaceResult Board::place(const Move& move) {
     size_t i = 0;
 
     // We determine the direction we are tranversing from the move.
-    Direction dir;
+    Direction dir = Direction::NONE;
     switch (move.direction) {
     case Direction::ACROSS:
         dir = Direction::ACROSS;
@@ -424,13 +432,49 @@ PlaceResult Board::place(const Move& move) {
     return result;
 }
 
+// place with a record of where the tiles went
+PlaceResult Board::place(const Move& move, std::vector<Position>& placed) {
+    placed.clear();
+
+    // The squares have to be found before placing, while we can still tell the
+    // tiles that were already on the board apart from the new ones.
+    if (move.kind == MoveKind::PLACE) {
+        Position curr(move.row, move.column);
+        for (size_t i = 0; i < move.tiles.size() && is_in_bounds(curr); ++i) {
+            while (in_bounds_and_has_tile(curr)) {
+                curr = curr.translate(move.direction);
+            }
+            placed.push_back(curr);
+            curr = curr.translate(move.direction);
+        }
+    }
+
+    PlaceResult result = place(move);
+    if (move.kind == MoveKind::PLACE && !result.valid) {
+        placed.clear();
+    }
+    return result;
+}
+
+// takes the tiles back off their squares and goes back one move
+void Board::unplace(const Move& move, const std::vector<Position>& placed) {
+    // a refused placement has no squares and was not counted as a move
+    if (move.kind == MoveKind::PLACE && placed.empty())
+        return;
+    for (size_t i = 0; i < placed.size(); ++i) {
+        at(placed[i]).clear_tile();
+    }
+    move_index--;
+}
+
 // finds all anchors of the current board
 std::vector<Board::Anchor> Board::get_anchors() const {
     std::vector<Anchor> output;  // vector of anchors to output
     size_t marker = 0;           // a marker to store the last anchor in the given column/row
 
-    // if it is the first move, the only anchors are the starting location
-    if (move_index == 0) {
+    // until a tile is on the start square, the only anchors are the starting location
+    // (passes and exchanges count as moves, so the move index cannot tell us this)
+    if (!at(start).has_tile()) {
         output.push_back(Anchor(start, Direction::ACROSS, start.column));
         output.push_back(Anchor(start, Direction::DOWN, start.row));
         return output;
@@ -491,6 +535,21 @@ std::vector<Board::Anchor> Board::get_anchors() const {
     return output;
 }
 
+// collects the tiles of every occupied square
+std::vector<TileKind> Board::placed_tiles() const {
+    std::vector<TileKind> output;
+    for (size_t row = 0; row < this->rows; row++) {
+        for (size_t col = 0; col < this->columns; col++) {
+            if (this->squares[row][col].has_tile()) {
+                output.push_back(this->squares[row][col].get_tile_kind());
+            }
+        }
+    }
+    return output;
+}
+
+void Board::set_tile(const Position& position, const TileKind& tile) { at(position).set_tile_kind(tile); }
+
 // The rest of this file is provided for you. No need to make changes.
 
 BoardSquare& Board::at(const Board::Position& position) { return this->squares.at(position.row).at(position.column); }
@@ -506,97 +565,3 @@ bool Board::is_in_bounds(const Board::Position& position) const {
 bool Board::in_bounds_and_has_tile(const Position& position) const {
     return is_in_bounds(position) && at(position).has_tile();
 }
-
-void Board::print(ostream& out) const {
-    // Draw horizontal number labels
-    for (size_t i = 0; i < BOARD_TOP_MARGIN - 2; ++i) {
-        out << std::endl;
-    }
-    out << FG_COLOR_LABEL << repeat(SPACE, BOARD_LEFT_MARGIN);
-    const size_t right_number_space = (SQUARE_OUTER_WIDTH - 3) / 2;
-    const size_t left_number_space = (SQUARE_OUTER_WIDTH - 3) - right_number_space;
-    for (size_t column = 0; column < this->columns; ++column) {
-        out << repeat(SPACE, left_number_space) << std::setw(2) << column + 1 << repeat(SPACE, right_number_space);
-    }
-    out << std::endl;
-
-    // Draw top line
-    out << repeat(SPACE, BOARD_LEFT_MARGIN);
-    print_horizontal(this->columns, L_TOP_LEFT, T_DOWN, L_TOP_RIGHT, out);
-    out << endl;
-
-    // Draw inner board
-    for (size_t row = 0; row < this->rows; ++row) {
-        if (row > 0) {
-            out << repeat(SPACE, BOARD_LEFT_MARGIN);
-            print_horizontal(this->columns, T_RIGHT, PLUS, T_LEFT, out);
-            out << endl;
-        }
-
-        // Draw insides of squares
-        for (size_t line = 0; line < SQUARE_INNER_HEIGHT; ++line) {
-            out << FG_COLOR_LABEL << BG_COLOR_OUTSIDE_BOARD;
-
-            // Output column number of left padding
-            if (line == 1) {
-                out << repeat(SPACE, BOARD_LEFT_MARGIN - 3);
-                out << std::setw(2) << row + 1;
-                out << SPACE;
-            } else {
-                out << repeat(SPACE, BOARD_LEFT_MARGIN);
-            }
-
-            // Iterate columns
-            for (size_t column = 0; column < this->columns; ++column) {
-                out << FG_COLOR_LINE << BG_COLOR_NORMAL_SQUARE << I_VERTICAL;
-                const BoardSquare& square = this->squares.at(row).at(column);
-                bool is_start = this->start.row == row && this->start.column == column;
-
-                // Figure out background color
-                if (square.word_multiplier == 2) {
-                    out << BG_COLOR_WORD_MULTIPLIER_2X;
-                } else if (square.word_multiplier == 3) {
-                    out << BG_COLOR_WORD_MULTIPLIER_3X;
-                } else if (square.letter_multiplier == 2) {
-                    out << BG_COLOR_LETTER_MULTIPLIER_2X;
-                } else if (square.letter_multiplier == 3) {
-                    out << BG_COLOR_LETTER_MULTIPLIER_3X;
-                } else if (is_start) {
-                    out << BG_COLOR_START_SQUARE;
-                }
-
-                // Text
-                if (line == 0 && is_start) {
-                    out << "  \u2605  ";
-                } else if (line == 0 && square.word_multiplier > 1) {
-                    out << FG_COLOR_MULTIPLIER << repeat(SPACE, SQUARE_INNER_WIDTH - 2) << 'W' << std::setw(1)
-                        << square.word_multiplier;
-                } else if (line == 0 && square.letter_multiplier > 1) {
-                    out << FG_COLOR_MULTIPLIER << repeat(SPACE, SQUARE_INNER_WIDTH - 2) << 'L' << std::setw(1)
-                        << square.letter_multiplier;
-                } else if (line == 1 && square.has_tile()) {
-                    char l = square.get_tile_kind().letter == TileKind::BLANK_LETTER ? square.get_tile_kind().assigned
-                                                                                     : ' ';
-                    out << repeat(SPACE, 2) << FG_COLOR_LETTER << square.get_tile_kind().letter << l
-                        << repeat(SPACE, 1);
-                } else if (line == SQUARE_INNER_HEIGHT - 1 && square.has_tile()) {
-                    // I fixed this so tht the board would be able to handle double digit letter scores
-                    if (square.get_points() > 9)
-                        out << repeat(SPACE, SQUARE_INNER_WIDTH - 2) << FG_COLOR_SCORE << square.get_points();
-                    else
-                        out << repeat(SPACE, SQUARE_INNER_WIDTH - 1) << FG_COLOR_SCORE << square.get_points();
-                } else {
-                    out << repeat(SPACE, SQUARE_INNER_WIDTH);
-                }
-            }
-
-            // Add vertical line
-            out << FG_COLOR_LINE << BG_COLOR_NORMAL_SQUARE << I_VERTICAL << BG_COLOR_OUTSIDE_BOARD << std::endl;
-        }
-    }
-
-    // Draw bottom line
-    out << repeat(SPACE, BOARD_LEFT_MARGIN);
-    print_horizontal(this->columns, L_BOTTOM_LEFT, T_UP, L_BOTTOM_RIGHT, out);
-    out << endl << rang::style::reset << std::endl;
-}
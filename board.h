@@ -6,7 +6,6 @@
 #include "move.h"
 #include "place_result.h"
 #include "tile_kind.h"
-#include <ostream>
 #include <string>
 #include <vector>
 
@@ -63,7 +62,17 @@ public:
     PlaceResult place(const Move& move);  // Used for testing - remember that the move struct should use 0 based
                                           // indexing, NOT 1 based
 
-    void print(std::ostream& out) const;
+    /*
+    Same as place(), but also records the positions the tiles were put on, so that unplace() can take the move back.
+    Searches use the pair to try moves on one board instead of copying it.
+    */
+    PlaceResult place(const Move& move, std::vector<Position>& placed);
+
+    /*
+    Takes back a move executed with place(move, placed), including passes and exchanges. A placement that place()
+    refused left the board as it was, so there is nothing to take back.
+    */
+    void unplace(const Move& move, const std::vector<Position>& placed);
 
     // Note: These methods have been made public
     bool is_in_bounds(const Position& position) const;
@@ -75,6 +84,12 @@ public:
     */
     char letter_at(Position p) const;
 
+    // Returns the tile at a position, which for a blank keeps the letter it stands for. Assumes there is a tile at p.
+    TileKind tile_at(Position p) const;
+
+    // Returns the square at a position, with its multipliers and tile, for drawing the board. Assumes p is in bounds.
+    const BoardSquare& square_at(Position p) const;
+
     /* HW5: IMPLEMENT THIS
     Returns bool indicating whether position p is an anchor spot or not.
 
@@ -94,6 +109,15 @@ public:
     */
     std::vector<Anchor> get_anchors() const;  // Used for testing
 
+    // Returns every tile that has been placed on the board.
+    std::vector<TileKind> placed_tiles() const;
+
+    /*
+    Puts a tile on a square without any of the checks or scoring of place(), and without counting a move. Used to set
+    up positions that were not reached by playing moves, such as those read from a position corpus.
+    */
+    void set_tile(const Position& position, const TileKind& tile);
+
 protected:
     Board(size_t rows, size_t columns, size_t starting_row, size_t starting_column)
             : rows(rows), columns(columns), start(starting_row - 1, starting_column - 1) {}
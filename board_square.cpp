@@ -9,6 +9,8 @@ void BoardSquare::set_tile_kind(TileKind kind) {
     this->tile_kind = kind;
 }
 
+void BoardSquare::clear_tile() { this->tile = false; }
+
 unsigned int BoardSquare::get_points() const {
     return this->has_tile() ? this->tile_kind.points * this->letter_multiplier : 0;
 }
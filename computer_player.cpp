@@ -1,12 +1,19 @@
 
 #include "computer_player.h"
 
+#include "game_state.h"
+#include "thread_pool.h"
+#include "trace.h"
 #include <algorithm>
-#include <iostream>
+#include <cctype>
+#include <stdexcept>
 #include <map>
 #include <memory>
 #include <string>
 
+// the number of anchors in each span of a trace, so that a trace shows how a search progresses
+static const size_t TRACE_ANCHOR_BATCH = 16;
+
 // left part finds all the possible prefixes of the given anchor that
 // can be made from the letters in hand, then calls extend right on each.
 void ComputerPlayer::left_part(
@@ -16,14 +23,16 @@ void ComputerPlayer::left_part(
         std::shared_ptr<Dictionary::TrieNode> node,
         size_t limit,
         TileCollection& remaining_tiles,
-        std::vector<Move>& legal_moves,
-        const Board& board) const {
+        MoveSink& sink,
+        const Board& board,
+        const CrossChecks* cross_checks) const {
 
     // an iterator to use with the node maps
     std::map<char, std::shared_ptr<Dictionary::TrieNode>>::iterator it;
+    MoveStats::count(sink.stats.left_part_nodes);
 
     // extend right from the starting position
-    extend_right(anchor_pos, partial_word, partial_move, node, remaining_tiles, legal_moves, board);
+    extend_right(anchor_pos, partial_word, partial_move, node, remaining_tiles, sink, board, cross_checks);
 
     // if there are possibilities for prefixes, create the prefixes that can be made from letters in
     // the current player's hand.
@@ -50,8 +59,9 @@ void ComputerPlayer::left_part(
                         it->second,
                         limit - 1,
                         remaining_tiles,
-                        legal_moves,
-                        board);
+                        sink,
+                        board,
+                        cross_checks);
 
                 // the tile that was added is removed so that additional
                 // left_part calls can be made with different prefixes.
@@ -61,8 +71,8 @@ void ComputerPlayer::left_part(
 
             // if there are blank tiles in hand, the same is called as above, except
             // with the blank tile (in which case a call can be made with every single
-            // child node)
-            if (remaining_tiles.has_tile('?')) {
+            // child node that is a letter: a blank cannot stand for an apostrophe)
+            if (std::isalpha(it->first) && remaining_tiles.has_tile('?')) {
                 Move newMove(partial_move);
                 if (partial_move.direction == Direction::ACROSS)
                     newMove.column--;
@@ -81,8 +91,9 @@ void ComputerPlayer::left_part(
                         it->second,
                         limit - 1,
                         remaining_tiles,
-                        legal_moves,
-                        board);
+                        sink,
+                        board,
+                        cross_checks);
                 remaining_tiles.add_tile(curr);
             }
         }
@@ -90,18 +101,20 @@ void ComputerPlayer::left_part(
 }
 
 // extend right creates all possible moves at the given anchor and with given
-// prefix, and adds them to the legal_moves vector
+// prefix, and hands them to the sink
 void ComputerPlayer::extend_right(
         Board::Position square,
         std::string partial_word,
         Move partial_move,
         std::shared_ptr<Dictionary::TrieNode> node,
         TileCollection& remaining_tiles,
-        std::vector<Move>& legal_moves,
-        const Board& board) const {
+        MoveSink& sink,
+        const Board& board,
+        const CrossChecks* cross_checks) const {
 
     // iterator to use throughout the function for map of next nodes
     std::map<char, std::shared_ptr<Dictionary::TrieNode>>::iterator it;
+    MoveStats::count(sink.stats.extend_right_nodes);
 
     // if there is a tile already on the board, the current node has its
     // children searched for the letter, and if it is found extend_right is
@@ -115,20 +128,30 @@ void ComputerPlayer::extend_right(
                     partial_move,
                     it->second,
                     remaining_tiles,
-                    legal_moves,
-                    board);
+                    sink,
+                    board,
+                    cross_checks);
         }
     } else {
         // otherwise, there is a blank space, and the tiles in hand are used
         // to determine moves that can be made
 
-        // if what has been made so far is a word, add the move to the list
+        // if what has been made so far is a word, hand the move and the tiles
+        // that are left over to the sink
         if (node->is_final) {
-            legal_moves.push_back(partial_move);
+            MoveStats::count(sink.stats.moves_generated);
+            sink.add(partial_move, remaining_tiles);
         }
 
+        // with cross checks, nothing is tried beyond the edge of the board
+        if (cross_checks != nullptr && !board.is_in_bounds(square))
+            return;
+
         // for every possible next letter, call extend right
         for (it = node->nexts.begin(); it != node->nexts.end(); it++) {
+            // skip letters that would form an invalid word across the move
+            if (cross_checks != nullptr && !cross_checks->allows(square, partial_move.direction, it->first))
+                continue;
 
             // if the hand contains the letter, call extend right on it
             // after doing necessary steps, and then backtrack
@@ -148,8 +171,9 @@ void ComputerPlayer::extend_right(
                         partial_move,
                         it->second,
                         remaining_tiles,
-                        legal_moves,
-                        board);
+                        sink,
+                        board,
+                        cross_checks);
 
                 // to backtrack, add tile back to hand and remove from partial move
                 remaining_tiles.add_tile(curr);
@@ -160,7 +184,8 @@ void ComputerPlayer::extend_right(
             // is possible
             // the only difference between this code and the code above is that
             // since the tile is blank, the letter is assigned to the assigned member
-            if (remaining_tiles.has_tile('?')) {
+            // (only letters, though: the dictionary's apostrophes have no tiles)
+            if (std::isalpha(it->first) && remaining_tiles.has_tile('?')) {
                 TileKind curr = remaining_tiles.lookup_tile('?');
                 curr.assigned = it->first;
                 partial_move.tiles.push_back(curr);
@@ -171,8 +196,9 @@ void ComputerPlayer::extend_right(
                         partial_move,
                         it->second,
                         remaining_tiles,
-                        legal_moves,
-                        board);
+                        sink,
+                        board,
+                        cross_checks);
                 remaining_tiles.add_tile(curr);
                 partial_move.tiles.pop_back();
             }
@@ -181,18 +207,267 @@ void ComputerPlayer::extend_right(
 }
 
 // finds all possible moves with the given tiles and board, and returns the best one
-// (the one that scores the highest)
+// (the one that scores the highest, or has the highest equity with a leave table)
 Move ComputerPlayer::get_move(const Board& board, const Dictionary& dictionary) const {
-    // print the board
-    board.print(std::cout);
+    MoveStats stats;
+    return get_move_with_stats(board, dictionary, stats);
+}
+
+Move ComputerPlayer::get_move_with_stats(const Board& board, const Dictionary& dictionary, MoveStats& stats) const {
+    PhaseTimer timer(stats.turn_time);
+    MoveStats::count(stats.turns);
+
+    // with the bag empty the solver can look all the way to the end of the game
+    SearchLimits limits = turn_limits();
+    Move endgame_move;
+    if (find_endgame_move(board, dictionary, limits, endgame_move))
+        return endgame_move;
+    if (find_pre_endgame_move(board, dictionary, limits, endgame_move))
+        return endgame_move;
+
+    // when time runs out this is the best move on the anchors searched so far
+    SearchResult result = search(board, dictionary, tiles, 1, limits, tiles_in_bag(board));
+    stats += result.stats;
+    const std::vector<ScoredMove>& best = result.moves;
+
+    // Pass if no move found that scores any points, unless exchanging is better
+    if (best.empty() || (best[0].move.kind == MoveKind::PLACE && best[0].points == 0))
+        return Move();
+    return best[0].move;
+}
+
+std::vector<ScoredMove> ComputerPlayer::best_moves(
+        const Board& board, const Dictionary& dictionary, const TileCollection& rack, size_t count) const {
+    TopMovesSink sink(board, dictionary, get_hand_size(), count, leaves.get());
+    CrossChecks cross_checks;
+    {
+        PhaseTimer timer(sink.stats.cross_check_time);
+        TraceSpan span("cross_checks", "search");
+        cross_checks = find_cross_checks(board, dictionary);
+    }
+    generate_moves(board, dictionary, rack, sink, &cross_checks);
+    return sink.moves();
+}
 
-    // initialize a vector of legal moves and get the vector of anchors using
-    // get_anchors
-    std::vector<Move> legal_moves;
-    std::vector<Board::Anchor> anchors = board.get_anchors();
+std::vector<ScoredMove> ComputerPlayer::reference_moves(
+        const Board& board, const Dictionary& dictionary, const TileCollection& rack) const {
+    MoveListSink candidates;
+    find_moves(board, dictionary, rack, candidates);
+    return rank_moves(candidates, board, dictionary, SIZE_MAX);
+}
+
+SearchResult ComputerPlayer::search(
+        const Board& board,
+        const Dictionary& dictionary,
+        const TileCollection& rack,
+        size_t count,
+        const SearchLimits& limits,
+        size_t exchange_limit) const {
+    SearchResult result;
+    result.anchors_total = board.get_anchors().size();
+    if (limits.expired())
+        return result;
+
+    // exchanges take microseconds, so they are always considered in full before the placements
+    TopMovesSink sink(board, dictionary, get_hand_size(), count, leaves.get());
+    generate_exchanges(rack, exchange_limit, sink);
+    CrossChecks cross_checks;
+    {
+        PhaseTimer timer(sink.stats.cross_check_time);
+        TraceSpan span("cross_checks", "search");
+        cross_checks = find_cross_checks(board, dictionary);
+    }
+    result.anchors_completed = generate_moves(board, dictionary, rack, sink, &cross_checks, &limits);
+    result.moves = sink.moves();
+    result.stats = sink.stats;
+    return result;
+}
+
+void ComputerPlayer::generate_exchanges(const TileCollection& rack, size_t max_tiles, MoveSink& sink) const {
+    std::vector<TileKind> rack_tiles;
+    for (TileCollection::const_iterator it = rack.cbegin(); it != rack.cend(); it++) {
+        rack_tiles.push_back(*it);
+    }
+    if (max_tiles == 0 || rack_tiles.empty() || rack_tiles.size() > 16)
+        return;
+
+    // copies of a letter are next to each other; bit i of repeats is set when tile i repeats tile i - 1
+    uint32_t repeats = 0;
+    for (size_t i = 1; i < rack_tiles.size(); i++) {
+        if (rack_tiles[i] == rack_tiles[i - 1])
+            repeats |= uint32_t(1) << i;
+    }
+
+    // exchanging everything comes first, so that it wins the tie when there is no leave table to tell them apart
+    uint32_t full = (uint32_t(1) << rack_tiles.size()) - 1;
+    for (uint32_t mask = full; mask > 0; mask--) {
+        // skip a subset that takes a copy of a letter without taking the copy before it
+        if (mask & ~(mask << 1) & repeats)
+            continue;
+        if (size_t(__builtin_popcount(mask)) > max_tiles)
+            continue;
+
+        std::vector<TileKind> exchanged;
+        TileCollection kept;
+        for (size_t i = 0; i < rack_tiles.size(); i++) {
+            if ((mask >> i) & 1)
+                exchanged.push_back(rack_tiles[i]);
+            else
+                kept.add_tile(rack_tiles[i]);
+        }
+        sink.add(Move(exchanged), kept);
+    }
+}
+
+size_t ComputerPlayer::tiles_in_bag(const Board& board) const {
+    if (!knows_distribution)
+        return 0;
+
+    // every opponent holds a full hand while the bag has tiles, and the rest of the unseen tiles are in the bag
+    size_t on_racks = (player_count > 1 ? player_count - 1 : 0) * get_hand_size();
+    size_t unseen = unseen_tiles(board).count_tiles();
+    return unseen > on_racks ? unseen - on_racks : 0;
+}
+
+bool ComputerPlayer::CrossChecks::allows(Board::Position square, Direction direction, char letter) const {
+    // the dictionary has a few words with apostrophes, but there are no tiles for them
+    if (letter < 'a' || letter > 'z')
+        return false;
+    const std::vector<uint32_t>& checks = direction == Direction::ACROSS ? across : down;
+    return (checks[square.row * columns + square.column] >> (letter - 'a')) & 1;
+}
+
+// works out which letters fit on each empty square, given the tiles on either side of it
+ComputerPlayer::CrossChecks ComputerPlayer::find_cross_checks(const Board& board, const Dictionary& dictionary) const {
+    CrossChecks checks;
+    checks.columns = board.columns;
+    checks.across.assign(board.rows * board.columns, uint32_t(ALL_LETTERS));
+    checks.down.assign(board.rows * board.columns, uint32_t(ALL_LETTERS));
+
+    for (size_t row = 0; row < board.rows; row++) {
+        for (size_t col = 0; col < board.columns; col++) {
+            Board::Position square(row, col);
+            if (board.in_bounds_and_has_tile(square))
+                continue;
+
+            // a move going in one direction forms words in the other
+            for (Direction direction : {Direction::ACROSS, Direction::DOWN}) {
+                Direction perpendicular = !direction;
+
+                // collect the letters before and after the square
+                std::string before;
+                Board::Position curr = square.translate(perpendicular, -1);
+                while (board.in_bounds_and_has_tile(curr)) {
+                    before += board.letter_at(curr);
+                    curr = curr.translate(perpendicular, -1);
+                }
+                std::reverse(before.begin(), before.end());
+                std::string after;
+                curr = square.translate(perpendicular);
+                while (board.in_bounds_and_has_tile(curr)) {
+                    after += board.letter_at(curr);
+                    curr = curr.translate(perpendicular);
+                }
+
+                // with no neighbours any letter fits
+                if (before.empty() && after.empty())
+                    continue;
+
+                // otherwise a letter fits if before + letter + after is a word
+                uint32_t mask = 0;
+                std::shared_ptr<Dictionary::TrieNode> node = dictionary.find_prefix(before);
+                if (node != nullptr) {
+                    for (auto it = node->nexts.begin(); it != node->nexts.end(); it++) {
+                        std::shared_ptr<Dictionary::TrieNode> end = it->second;
+                        for (size_t i = 0; i < after.size() && end != nullptr; i++) {
+                            auto next = end->nexts.find(after[i]);
+                            end = next == end->nexts.end() ? nullptr : next->second;
+                        }
+                        if (end != nullptr && end->is_final && it->first >= 'a' && it->first <= 'z')
+                            mask |= uint32_t(1) << (it->first - 'a');
+                    }
+                }
+                (direction == Direction::ACROSS ? checks.across : checks.down)[row * board.columns + col] = mask;
+            }
+        }
+    }
+    return checks;
+}
+
+bool ComputerPlayer::find_endgame_move(
+        const Board& board, const Dictionary& dictionary, const SearchLimits& limits, Move& move) const {
+    // the solvers play against a single opponent
+    if (!solve_endgames || !knows_distribution || player_count != 2)
+        return false;
+
+    // while the bag has tiles the opponent holds a full hand, so we only see fewer
+    // unseen tiles than that once the bag is empty; they are then the opponent's rack
+    TileCollection unseen = unseen_tiles(board);
+    if (unseen.count_tiles() == 0 || unseen.count_tiles() > get_hand_size())
+        return false;
+
+    EndgameSettings settings = endgame_settings;
+    settings.time_limit = std::min(settings.time_limit, limits.remaining(settings.time_limit));
+    settings.cancellation = limits.cancellation;
+    EndgameSolver solver(*this, dictionary, settings);
+    EndgameResult result = solver.solve(board, tiles, unseen);
+    if (result.sequence.empty())
+        return false;
+    move = result.sequence[0];
+    return true;
+}
+
+void ComputerPlayer::observe_move(const Move& move, bool own_move) {
+    if (knows_distribution)
+        tracker.observe_move(move, own_move);
+}
+
+TileCollection ComputerPlayer::unseen_tiles(const Board& board) const {
+    if (!knows_distribution) {
+        throw std::logic_error("the tile distribution is unknown");
+    }
+
+    if (tracker.moves_observed() == board.get_move_index())
+        return tracker.unseen(tiles);
+
+    // start from every tile in the game and take away everything that can be seen
+    TileCollection unseen(distribution);
+    std::vector<TileKind> placed = board.placed_tiles();
+    for (size_t i = 0; i < placed.size(); i++) {
+        unseen.remove_tile(placed[i]);
+    }
+    for (TileCollection::const_iterator it = tiles.cbegin(); it != tiles.cend(); it++) {
+        unseen.remove_tile(*it);
+    }
+    return unseen;
+}
+
+// collects every candidate move for the given rack
+void ComputerPlayer::find_moves(
+        const Board& board, const Dictionary& dictionary, const TileCollection& rack, MoveListSink& sink) const {
+    generate_moves(board, dictionary, rack, sink, nullptr);
+}
+
+// generates every candidate move for the given rack
+size_t ComputerPlayer::generate_moves(
+        const Board& board,
+        const Dictionary& dictionary,
+        const TileCollection& rack,
+        MoveSink& sink,
+        const CrossChecks* cross_checks,
+        const SearchLimits* limits) const {
+    // get the vector of anchors using get_anchors
+    std::vector<Board::Anchor> anchors;
+    {
+        PhaseTimer timer(sink.stats.anchor_time);
+        TraceSpan span("get_anchors", "search");
+        anchors = board.get_anchors();
+    }
+    PhaseTimer timer(sink.stats.generation_time);
+    TraceSpan batch("anchors", "search");
 
     // create a copy of the hand to pass to the function
-    TileCollection remaining(tiles);
+    TileCollection remaining(rack);
 
     // create a blank Place move to pass to the function
     Move partial_move = Move();
@@ -200,6 +475,13 @@ Move ComputerPlayer::get_move(const Board& board, const Dictionary& dictionary)
 
     // call left_part at every anchor
     for (size_t i = 0; i < anchors.size(); i++) {
+        // an anchor is always searched completely, so the moves found so far are whole anchors' worth
+        if (limits != nullptr && limits->expired())
+            return i;
+        MoveStats::count(sink.stats.anchors);
+        if (i > 0 && i % TRACE_ANCHOR_BATCH == 0)
+            batch.restart();
+
         // set the direction of the partial move based on the info
         // from the anchor, as well as the row and column
         partial_move.direction = anchors[i].direction;
@@ -216,8 +498,9 @@ Move ComputerPlayer::get_move(const Board& board, const Dictionary& dictionary)
                     dictionary.get_root(),
                     anchors[i].limit,
                     remaining,
-                    legal_moves,
-                    board);
+                    sink,
+                    board,
+                    cross_checks);
         // if limit is zero, instead of calling left_part, if there are
         // tiles to the left (or above), the tiles are iterated through
         // to get the starting prefix, after which extend_right is called
@@ -236,28 +519,28 @@ Move ComputerPlayer::get_move(const Board& board, const Dictionary& dictionary)
             // get the node corresponding to the current prefix
             std::shared_ptr<Dictionary::TrieNode> node = dictionary.find_prefix(prefix);
 
-            // call extend_right on it
-            extend_right(anchors[i].position, prefix, partial_move, node, remaining, legal_moves, board);
+            // call extend_right on it (the tiles on the board may not start any word)
+            if (node != nullptr)
+                extend_right(
+                        anchors[i].position, prefix, partial_move, node, remaining, sink, board, cross_checks);
         }
     }
-
-    // after getting all the legal moves, we return the best one
-    return get_best_move(legal_moves, board, dictionary);
+    return anchors.size();
 }
 
-// given a vector of moves, returns the highest scoring one
-Move ComputerPlayer::get_best_move(
-        std::vector<Move> legal_moves, const Board& board, const Dictionary& dictionary) const {
-
-    Move best_move = Move();       // Pass if no move found
-    unsigned int best_points = 0;  // stores the point value of the current best move
+// scores every valid move and keeps the highest scoring ones
+std::vector<ScoredMove> ComputerPlayer::rank_moves(
+        const MoveListSink& legal_moves, const Board& board, const Dictionary& dictionary, size_t count) const {
+    // the valid moves are kept packed with their points, and only the ones returned are unpacked
+    std::vector<std::pair<PackedMove, unsigned int>> ranked;
 
-    // for every move in the vector, tests the move and updates best move if it is better
-    for (size_t i = 0; i < legal_moves.size(); i++) {
+    // for every move in the vector, tests the move and keeps it if it is valid
+    for (size_t i = 0; i < legal_moves.moves.size(); i++) {
         bool not_all_words = false;  // flag for if an invalid word is created
+        Move move = legal_moves.moves[i].unpack(legal_moves.tile_points);
 
         // the move is tested with test_place
-        PlaceResult result = board.test_place(legal_moves[i]);
+        PlaceResult result = board.test_place(move);
 
         // We check to make sure every word created by the user's move is in the dictionary,
         // and set our flag to true otherwise.
@@ -268,22 +551,64 @@ Move ComputerPlayer::get_best_move(
         }
 
         // if all the words are valid, the move itself is valid, and the move is not a pass,
-        // the best move is updated
-        if (!not_all_words && result.valid && !legal_moves[i].tiles.empty()) {
-            if (legal_moves[i].tiles.size() == get_hand_size()) {
-                if (result.points + 50 > best_points) {
-                    best_move = legal_moves[i];
-                    best_points = result.points + 50;
-                }
+        // the move is kept along with its points (including the bonus for using the whole hand)
+        if (!not_all_words && result.valid && !move.tiles.empty()) {
+            if (move.tiles.size() == get_hand_size()) {
+                ranked.push_back(std::make_pair(legal_moves.moves[i], result.points + GameState::EMPTY_HAND_BONUS));
             } else {
-                if (result.points > best_points) {
-                    best_move = legal_moves[i];
-                    best_points = result.points;
-                }
+                ranked.push_back(std::make_pair(legal_moves.moves[i], result.points));
             }
         }
     }
 
-    // the best move is returned
-    return best_move;
+    // the highest scoring moves are moved to the front; ties keep the order they were found in
+    typedef std::pair<PackedMove, unsigned int> RankedMove;
+    std::stable_sort(ranked.begin(), ranked.end(), [](const RankedMove& a, const RankedMove& b) {
+        return a.second > b.second;
+    });
+
+    // a single tile is found once from each direction, so identical placements are only kept once
+    std::vector<PackedMove> kept;
+    std::vector<ScoredMove> output;
+    for (size_t i = 0; i < ranked.size() && output.size() < count; i++) {
+        const PackedMove& a = ranked[i].first;
+        bool duplicate = false;
+        for (size_t j = 0; j < kept.size() && !duplicate; j++) {
+            const PackedMove& b = kept[j];
+            duplicate = a.count == 1 && b.count == 1 && a.row == b.row && a.column == b.column
+                        && a.tiles[0] == b.tiles[0];
+        }
+        if (!duplicate) {
+            kept.push_back(a);
+            output.push_back(ScoredMove(a.unpack(legal_moves.tile_points), ranked[i].second));
+        }
+    }
+    return output;
+}
+
+// the pool is started once here rather than for every solve, which would spend the turn's time starting threads
+void ComputerPlayer::enable_pre_endgame_solver(const PreEndgameSettings& settings) {
+    pre_endgame_settings = settings;
+    size_t threads = settings.threads == 0 ? ThreadPool::hardware_threads() : settings.threads;
+    if (pre_endgame_settings.pool == nullptr && threads > 1)
+        pre_endgame_settings.pool = std::make_shared<ThreadPool>(threads);
+    solve_pre_endgames = true;
+}
+
+bool ComputerPlayer::find_pre_endgame_move(
+        const Board& board, const Dictionary& dictionary, const SearchLimits& limits, Move& move) const {
+    if (!solve_pre_endgames || !knows_distribution || player_count != 2)
+        return false;
+
+    size_t bag_size = tiles_in_bag(board);
+    if (bag_size == 0 || bag_size > pre_endgame_settings.max_bag_tiles)
+        return false;
+    TileCollection unseen = unseen_tiles(board);
+
+    PreEndgameSettings settings = pre_endgame_settings;
+    settings.time_limit = std::min(settings.time_limit, limits.remaining(settings.time_limit));
+    settings.endgame.cancellation = limits.cancellation;
+    PreEndgameSolver solver(*this, dictionary, settings);
+    move = solver.solve(board, tiles, unseen, bag_size).move;
+    return true;
 }
@@ -1,8 +1,37 @@
 #ifndef COMPUTER_PLAYER_H
 #define COMPUTER_PLAYER_H
 
+#include "endgame_solver.h"
+#include "leave_table.h"
 #include "move.h"
+#include "move_sink.h"
 #include "player.h"
+#include "pre_endgame_solver.h"
+#include "search_limits.h"
+#include "tile_collection.h"
+#include "tile_tracker.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/*
+The outcome of a move search that may have been stopped early. Anchors are searched one at a time, so the moves are
+the best found on the anchors that were completed.
+*/
+struct SearchResult {
+    std::vector<ScoredMove> moves;
+    size_t anchors_completed = 0;
+    size_t anchors_total = 0;
+    MoveStats stats;
+
+    bool complete() const { return anchors_completed == anchors_total; }
+
+    // The fraction of the anchors that were searched, 1 when the search finished.
+    double completed_fraction() const {
+        return anchors_total == 0 ? 1.0 : double(anchors_completed) / anchors_total;
+    }
+};
 
 class ComputerPlayer : public Player {
 public:
@@ -11,6 +40,47 @@ public:
     */
     ComputerPlayer(const std::string& name, size_t hand_size) : Player(name, hand_size) {}  // <--- FIX THIS LINE
 
+    /*
+    distribution: every tile the game is played with (the full bag before any hand was drawn). Knowing it lets the
+    player work out which tiles it has not seen yet.
+    */
+    ComputerPlayer(const std::string& name, size_t hand_size, const TileCollection& distribution)
+            : Player(name, hand_size),
+              distribution(distribution),
+              knows_distribution(true),
+              tracker(distribution, hand_size) {}
+
+    /*
+    Makes the player rank moves by equity (points plus the value of the tiles kept) instead of by points alone.
+    Passing null goes back to ranking by points.
+    */
+    void set_leave_table(std::shared_ptr<const LeaveTable> leave_table) { leaves = leave_table; }
+
+    /*
+    Makes the player solve the endgame once the bag is empty instead of playing its best scoring move. The player
+    must have been given the tile distribution. The solver is only used in two player games, where the unseen tiles
+    are exactly the opponent's rack.
+    */
+    void enable_endgame_solver(const EndgameSettings& settings) {
+        endgame_settings = settings;
+        solve_endgames = true;
+    }
+
+    /*
+    Makes the player compare its best moves by solving the endgames that follow them once the bag holds only a few
+    tiles. Like the endgame solver, this needs the tile distribution and is only used in two player games.
+    */
+    void enable_pre_endgame_solver(const PreEndgameSettings& settings);
+
+    /*
+    Bounds every call to get_move: the whole turn, endgame solving included, stops after time_limit and returns the
+    best move found by then. Zero removes the limit.
+    */
+    void set_move_time_limit(std::chrono::milliseconds time_limit) { move_time_limit = time_limit; }
+
+    // Lets another thread cancel get_move, which then returns the best move found so far.
+    void set_cancellation_token(std::shared_ptr<const CancellationToken> token) { cancellation = token; }
+
     /* HW5: IMPLEMENT THIS
     Returns the move found by running the algorithm given here:
         https://www.cs.cmu.edu/afs/cs/academic/class/15451-s06/www/lectures/scrabble.pdf
@@ -19,8 +89,144 @@ public:
     */
     Move get_move(const Board& board, const Dictionary& dictionary) const override;  // Used For Testing
 
+    // Finds the move get_move returns, counting the search's work and timing the turn in stats.
+    Move get_move_with_stats(const Board& board, const Dictionary& dictionary, MoveStats& stats) const override;
+
     bool is_human() const { return false; }
 
+    // Keeps the unseen tile pool up to date when the player knows the distribution.
+    void observe_move(const Move& move, bool own_move) override;
+
+    // The number of players tells how many unseen tiles are on other racks, and whether the solvers apply.
+    void set_player_count(size_t count) override { player_count = count; }
+
+    /*
+    Returns up to count of the legal moves that can be made with rack on board, best first. Moves are ranked by
+    equity when the player has a leave table and by points otherwise.
+    The rack does not have to be this player's hand, which lets simulations generate moves for the opponent.
+    */
+    std::vector<ScoredMove> best_moves(
+            const Board& board, const Dictionary& dictionary, const TileCollection& rack, size_t count) const;
+
+    /*
+    Like best_moves, but checks limits before each anchor and stops once they are reached, returning the best moves
+    found so far and how many anchors were searched.
+    Exchanges of up to exchange_limit tiles (the number of tiles in the bag) compete with the placements; with the
+    default of zero none are considered.
+    */
+    SearchResult search(
+            const Board& board,
+            const Dictionary& dictionary,
+            const TileCollection& rack,
+            size_t count,
+            const SearchLimits& limits,
+            size_t exchange_limit = 0) const;
+
+    /*
+    Returns every legal placement with rack, highest scoring first, found the original way: generation without cross
+    checks, after which every move is checked with test_place and the dictionary. Much slower than best_moves, but
+    simple enough to be the reference that faster generation is compared against.
+    */
+    std::vector<ScoredMove> reference_moves(
+            const Board& board, const Dictionary& dictionary, const TileCollection& rack) const;
+
+    /*
+    Hands sink every distinct exchange of up to max_tiles tiles from rack, with the tiles it keeps. Subsets of the
+    rack are enumerated as bit masks, and a subset that takes a later copy of a letter without the earlier ones is
+    skipped, so each distinct exchange is found once.
+    */
+    void generate_exchanges(const TileCollection& rack, size_t max_tiles, MoveSink& sink) const;
+
+    /*
+    Returns the tiles this player has not seen: the distribution minus the tiles on the board and in hand.
+    These are the tiles that are in the bag or on the opponents' racks. They come from the tracker when the player
+    has observed every move on board, and from a scan of the board otherwise.
+    Throws a logic_error if the player was not given the distribution.
+    */
+    TileCollection unseen_tiles(const Board& board) const;
+
+    /*
+    For every square, the letters that can be placed there without forming a perpendicular word that is not in the
+    dictionary, as bit masks with bit 0 for 'a'. `across` is used by moves going across (and so checks the words
+    formed downwards), `down` by moves going down.
+    */
+    struct CrossChecks {
+        size_t columns;
+        std::vector<uint32_t> across;
+        std::vector<uint32_t> down;
+
+        bool allows(Board::Position square, Direction direction, char letter) const;
+    };
+
+    CrossChecks find_cross_checks(const Board& board, const Dictionary& dictionary) const;
+
+protected:
+    static const uint32_t ALL_LETTERS = (uint32_t(1) << 26) - 1;
+
+    TileCollection distribution;
+    bool knows_distribution = false;
+    TileTracker tracker;
+    std::shared_ptr<const LeaveTable> leaves;
+    bool solve_endgames = false;
+    EndgameSettings endgame_settings;
+    bool solve_pre_endgames = false;
+    PreEndgameSettings pre_endgame_settings;
+    std::chrono::milliseconds move_time_limit{0};
+    std::shared_ptr<const CancellationToken> cancellation;
+    size_t player_count = 2;
+
+    // The limits for a turn starting now.
+    SearchLimits turn_limits() const { return SearchLimits::after(move_time_limit, cancellation); }
+
+    /*
+    The number of tiles in the bag, worked out from the unseen tiles: while the bag has tiles every opponent holds a
+    full hand. Zero when the player does not know the distribution, since the bag cannot be seen.
+    */
+    size_t tiles_in_bag(const Board& board) const;
+
+    /*
+    If the endgame solver is enabled and the bag is empty, solves the endgame, stores the first move of the best
+    line in move and returns true. Returns false otherwise. The solver's time limit is cut short by limits.
+    */
+    bool find_endgame_move(
+            const Board& board, const Dictionary& dictionary, const SearchLimits& limits, Move& move) const;
+
+    /*
+    If the pre-endgame solver is enabled and the bag holds between one and its maximum number of tiles, stores the
+    move it chooses in move and returns true. Returns false otherwise. The solver's time limit is cut short by limits.
+    */
+    bool find_pre_endgame_move(
+            const Board& board, const Dictionary& dictionary, const SearchLimits& limits, Move& move) const;
+
+    /*
+    Runs left_part and extend_right from every anchor and hands every move they find with rack to sink.
+    With cross_checks, letters that would form an invalid perpendicular word are never tried; without them (null)
+    every word along the move is generated and left for the sink to check.
+    With limits, they are checked before each anchor and generation stops once they are reached.
+    Returns the number of anchors searched.
+    */
+    size_t generate_moves(
+            const Board& board,
+            const Dictionary& dictionary,
+            const TileCollection& rack,
+            MoveSink& sink,
+            const CrossChecks* cross_checks,
+            const SearchLimits* limits = nullptr) const;
+
+    /*
+    Hands sink all the moves generate_moves finds with rack, without cross checks. The moves still have to be checked
+    with test_place and the dictionary.
+    */
+    void find_moves(
+            const Board& board, const Dictionary& dictionary, const TileCollection& rack, MoveListSink& sink) const;
+
+    /*
+    Checks and scores each of the moves in legal_moves, and returns up to count of the valid ones, highest scoring
+    first. The moves stay packed until they are returned.
+    */
+    std::vector<ScoredMove> rank_moves(
+            const MoveListSink& legal_moves, const Board& board, const Dictionary& dictionary, size_t count) const;
+
 private:
     // The following functions may be modified in any way.
     // e.g. You may decide you'd prefer to pass in a Dictionary reference rather than
@@ -38,10 +244,11 @@ private:
         Passed by reference
         Tiles should be removed when every searching forward on that tile
         Tiles should be put back in remaining_tiles when backtracking
-    legal_moves: A vector that accumulates Moves that create a valid word
+    sink: Receives every Move that creates a valid word, along with the tiles left over
         Note: Does not necessarily need to check perpendicular words while searching
               but it can if you prefer.
     board: a reference to the scrabble board
+    cross_checks: the letters allowed on each square, or null to try every letter
     */
     void left_part(
             Board::Position anchor_pos,
@@ -50,8 +257,9 @@ private:
             std::shared_ptr<Dictionary::TrieNode> node,
             size_t limit,
             TileCollection& remaining_tiles,
-            std::vector<Move>& legal_moves,
-            const Board& board) const;
+            MoveSink& sink,
+            const Board& board,
+            const CrossChecks* cross_checks) const;
 
     /*
     Given a square (not necessarily an anchor square) and a prefix finds all legal ways to extend the word to make valid
@@ -66,10 +274,11 @@ private:
         Passed by reference
         Tiles should be removed when every searching forward on that tile
         Tiles should be put back in remaining_tiles when backtracking
-    legal_moves: A vector that accumulates Moves that create a valid word
+    sink: Receives every Move that creates a valid word, along with the tiles left over
         Note: Does not necessarily need to check perpendicular words while searching
               but it can if you prefer.
     board: a reference to the scrabble board
+    cross_checks: the letters allowed on each square, or null to try every letter
     */
     void extend_right(
             Board::Position square,
@@ -77,14 +286,9 @@ private:
             Move partial_move,
             std::shared_ptr<Dictionary::TrieNode> node,
             TileCollection& remaining_tiles,
-            std::vector<Move>& legal_moves,
-            const Board& board) const;
-
-    /*
-    Searches the vector of legal moves for the highest scoring move
-    Ties broken arbitrarily
-    */
-    Move get_best_move(std::vector<Move> legal_moves, const Board& board, const Dictionary& dictionary) const;
+            MoveSink& sink,
+            const Board& board,
+            const CrossChecks* cross_checks) const;
 };
 
 #endif
@@ -0,0 +1,231 @@
+#include "computer_player.h"
+#include "dictionary.h"
+#include "exceptions.h"
+#include "game_state.h"
+#include "leave_table.h"
+#include "position_corpus.h"
+#include "rng.h"
+#include "scrabble_config.h"
+#include "tile_bag.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace std;
+
+struct CorpusOptions {
+    string config_path;
+    size_t games = 20;
+    size_t positions = 100;
+    uint64_t seed = 0;
+    bool has_seed = false;
+    string out_path;
+};
+
+/*
+What a position is sampled by: how full the board is (in quarters of the tiles in the bag), how many blanks the
+rack holds, and the shape of the rest of the rack.
+*/
+struct Stratum {
+    size_t fill;
+    size_t blanks;
+    size_t vowels;  // 0 for fewer than two vowels, 1 for two to four, 2 for five or more
+
+    bool operator<(const Stratum& other) const {
+        return tie(fill, blanks, vowels) < tie(other.fill, other.blanks, other.vowels);
+    }
+};
+
+void print_usage(const char* program) {
+    cerr << "Usage: " << program << " <configuration file> [--games N] [--positions N] [--seed N] [--out FILE]"
+         << endl;
+    cerr << "Plays seeded computer games and writes a corpus of positions spread over board fill, blanks and "
+            "vowels on the rack."
+         << endl;
+}
+
+// Reads the command line into options. Returns false if it is malformed.
+bool parse_options(int argc, char** argv, CorpusOptions& options) {
+    if (argc < 2) {
+        return false;
+    }
+    options.config_path = argv[1];
+    for (int i = 2; i < argc; i += 2) {
+        if (i + 1 >= argc) {
+            return false;
+        }
+        string flag = argv[i];
+        string value = argv[i + 1];
+        if (flag == "--games") {
+            options.games = stoul(value);
+        } else if (flag == "--positions") {
+            options.positions = stoul(value);
+        } else if (flag == "--seed") {
+            options.seed = stoull(value);
+            options.has_seed = true;
+        } else if (flag == "--out") {
+            options.out_path = value;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+Stratum stratum_of(const CorpusPosition& position, size_t bag_size) {
+    Stratum stratum{0, 0, 0};
+    size_t quarter = max(bag_size / 4, size_t(1));
+    stratum.fill = min(position.board.placed_tiles().size() / quarter, size_t(3));
+    size_t vowels = 0;
+    for (TileCollection::const_iterator it = position.rack.cbegin(); it != position.rack.cend(); it++) {
+        if (it->letter == TileKind::BLANK_LETTER) {
+            stratum.blanks++;
+        } else if (strchr("AEIOU", toupper(it->letter)) != nullptr) {
+            vowels++;
+        }
+    }
+    stratum.vowels = vowels < 2 ? 0 : vowels <= 4 ? 1 : 2;
+    return stratum;
+}
+
+/*
+Plays one game between a greedy player and, with a leave table, an equity player, and keeps the position before
+every turn. Different kinds of player leave different boards and racks behind them.
+*/
+vector<CorpusPosition> play_game(
+        const Board& start,
+        const TileBag& tile_bag,
+        const Dictionary& dictionary,
+        const shared_ptr<const LeaveTable>& leaves,
+        size_t hand_size,
+        size_t game,
+        uint64_t seed) {
+    vector<CorpusPosition> samples;
+    TileBag bag(tile_bag);
+    bag.reseed(seed);
+    GameState state(start, bag, dictionary, hand_size);
+    // the players know the distribution, so that they exchange when it pays as they would in a real game
+    TileCollection distribution = tile_bag.to_collection();
+    shared_ptr<ComputerPlayer> greedy = make_shared<ComputerPlayer>("greedy", hand_size, distribution);
+    shared_ptr<ComputerPlayer> equity = make_shared<ComputerPlayer>("equity", hand_size, distribution);
+    equity->set_leave_table(leaves);
+    state.add_player(greedy);
+    state.add_player(equity);
+
+    while (!state.is_over()) {
+        string name = "game" + to_string(game) + "-turn" + to_string(state.get_turn_count());
+        samples.push_back(CorpusPosition{name, state.get_board(), state.current_player().get_tiles()});
+        state.step();
+    }
+    return samples;
+}
+
+/*
+Takes positions from every stratum in turn, at random within each one, until enough are taken, so that the rare
+kinds of position (two blanks, no vowels, a nearly full board) are not drowned out by the common ones. The positions
+taken are returned in game order.
+*/
+vector<CorpusPosition> sample_positions(
+        const vector<CorpusPosition>& samples, size_t count, size_t bag_size, Rng& random) {
+    map<Stratum, vector<size_t>> strata;
+    for (size_t i = 0; i < samples.size(); i++) {
+        strata[stratum_of(samples[i], bag_size)].push_back(i);
+    }
+    for (pair<const Stratum, vector<size_t>>& stratum : strata) {
+        random.shuffle(stratum.second.begin(), stratum.second.end());
+    }
+
+    vector<size_t> taken;
+    for (size_t round = 0; taken.size() < min(count, samples.size()); round++) {
+        for (const pair<const Stratum, vector<size_t>>& stratum : strata) {
+            if (round < stratum.second.size() && taken.size() < count) {
+                taken.push_back(stratum.second[round]);
+            }
+        }
+    }
+    sort(taken.begin(), taken.end());
+
+    vector<CorpusPosition> sampled;
+    for (size_t i : taken) {
+        sampled.push_back(samples[i]);
+    }
+    return sampled;
+}
+
+// Writes how many of the sampled positions fall into each stratum, as comments the corpus reader skips.
+void write_strata(
+        ostream& out, const CorpusOptions& options, const vector<CorpusPosition>& sampled, size_t bag_size) {
+    map<Stratum, size_t> counts;
+    for (const CorpusPosition& sample : sampled) {
+        counts[stratum_of(sample, bag_size)]++;
+    }
+    out << "# " << sampled.size() << " positions from " << options.games << " games with seed " << options.seed
+        << '\n';
+    out << "# fill quarter, rack blanks, rack vowels (0: under two, 1: two to four, 2: five or more): positions\n";
+    for (const pair<const Stratum, size_t>& count : counts) {
+        out << "# " << count.first.fill << ", " << count.first.blanks << ", " << count.first.vowels << ": "
+            << count.second << '\n';
+    }
+    out << '\n';
+}
+
+// Plays seeded games and writes a position corpus for bench and perft. The same options always give the same corpus.
+int main(int argc, char** argv) {
+    CorpusOptions options;
+    try {
+        if (!parse_options(argc, argv, options)) {
+            print_usage(argv[0]);
+            return 1;
+        }
+    } catch (const logic_error& e) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    try {
+        ScrabbleConfig config = ScrabbleConfig::read(options.config_path);
+        if (!options.has_seed) {
+            options.seed = config.seed;
+        }
+        Dictionary dictionary = Dictionary::read(config.dictionary_file_path);
+        Board board = Board::read(config.board_file_path);
+        TileBag tile_bag = TileBag::read(config.tile_bag_file_path, config.seed);
+        size_t bag_size = tile_bag.count_tiles();
+        shared_ptr<const LeaveTable> leaves;
+        if (!config.leave_file_path.empty()) {
+            leaves = make_shared<LeaveTable>(LeaveTable::read(config.leave_file_path));
+        }
+
+        vector<CorpusPosition> samples;
+        for (size_t game = 0; game < options.games; game++) {
+            vector<CorpusPosition> played = play_game(
+                    board, tile_bag, dictionary, leaves, config.hand_size, game, Rng::derive_seed(options.seed, game));
+            samples.insert(samples.end(), played.begin(), played.end());
+        }
+        Rng random(Rng::derive_seed(options.seed, options.games));
+        vector<CorpusPosition> sampled = sample_positions(samples, options.positions, bag_size, random);
+
+        if (options.out_path.empty()) {
+            write_strata(cout, options, sampled, bag_size);
+            PositionCorpus::write(cout, sampled);
+        } else {
+            ofstream out(options.out_path);
+            if (!out) {
+                throw FileException("cannot open corpus output file!");
+            }
+            write_strata(out, options, sampled, bag_size);
+            PositionCorpus::write(out, sampled);
+        }
+    } catch (const FileException& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -1,11 +1,15 @@
 #include "dictionary.h"
 
 #include "exceptions.h"
+#include "thread_pool.h"
+#include "trace.h"
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cctype>
 #include <fstream>
-#include <iostream>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 using namespace std;
@@ -18,6 +22,7 @@ string lower(string str) {
 // Implemented for you to read dictionary file and
 // construct dictionary trie graph for you
 Dictionary Dictionary::read(const std::string& file_path) {
+    TraceSpan span("dictionary_read", "load");
     ifstream file(file_path);
     if (!file) {
         throw FileException("cannot open dictionary file!");
@@ -97,3 +102,173 @@ vector<char> Dictionary::next_letters(const std::string& prefix) const {
     // return nexts
     return nexts;
 }
+
+// how many words a parallel search collects before taking the lock to hand them on
+static const size_t SEARCH_BATCH = 256;
+
+/*
+One walk of the trie for a query: the word so far, with the rack tiles and required letters it has not used yet.
+Letters are taken and given back as the walk goes down and up, so one instance serves a whole subtree.
+*/
+class WordSearch {
+public:
+    WordSearch(
+            const WordQuery& query,
+            const function<bool(const string&)>& on_word,
+            const atomic<bool>& stopped)
+            : pattern(lower(query.pattern)),
+              use_rack(query.use_rack),
+              on_word(on_word),
+              stopped(stopped) {
+        min_length = pattern.empty() ? max<size_t>(query.min_length, 1) : pattern.size();
+        max_length = pattern.empty() ? query.max_length : pattern.size();
+        rack.fill(0);
+        needed.fill(0);
+        for (char letter : lower(query.rack)) {
+            if (letter == '?')
+                blanks++;
+            else
+                rack[static_cast<unsigned char>(letter)]++;
+        }
+        for (char letter : lower(query.contains)) {
+            needed[static_cast<unsigned char>(letter)]++;
+            needed_total++;
+        }
+        // a rack bounds how many letters can be placed, on top of those the pattern fixes
+        if (use_rack && pattern.empty())
+            max_length = min(max_length, query.rack.size());
+    }
+
+    // The letters of the pattern before its first '?', which every match starts with.
+    string fixed_prefix() const { return pattern.substr(0, min(pattern.find('?'), pattern.size())); }
+
+    // Goes down the letters of prefix without looking for words on the way. They must be fixed by the pattern.
+    void enter_prefix(const string& prefix) {
+        for (char letter : prefix) {
+            take(letter);
+        }
+    }
+
+    // Looks for words in the subtree of node. Returns false once on_word or another thread has stopped the search.
+    bool walk(const Dictionary::TrieNode& node) {
+        if (stopped.load(memory_order_relaxed))
+            return false;
+        size_t length = word.size();
+        if (node.is_final && length >= min_length && length <= max_length && needed_total == 0 && !on_word(word))
+            return false;
+        if (length >= max_length || needed_total > max_length - length)
+            return true;
+
+        char fixed = pattern.empty() ? '?' : pattern[length];
+        if (fixed != '?') {
+            map<char, shared_ptr<Dictionary::TrieNode>>::const_iterator it = node.nexts.find(fixed);
+            return it == node.nexts.end() || follow(*it->second, fixed);
+        }
+        for (const pair<const char, shared_ptr<Dictionary::TrieNode>>& next : node.nexts) {
+            if (!follow(*next.second, next.first))
+                return false;
+        }
+        return true;
+    }
+
+    // Walks child, the node of letter below the current word, if the rack has a tile for it.
+    bool follow(const Dictionary::TrieNode& child, char letter) {
+        bool from_rack = use_rack && (pattern.empty() || pattern[word.size()] == '?');
+        bool blank = false;
+        if (from_rack) {
+            unsigned char index = static_cast<unsigned char>(letter);
+            // the letter's own tile is always used before a blank, which could stand for anything later on
+            if (rack[index] > 0) {
+                rack[index]--;
+            } else if (blanks > 0) {
+                blanks--;
+                blank = true;
+            } else {
+                return true;
+            }
+        }
+        bool required = take(letter);
+        bool more = walk(child);
+        word.pop_back();
+        if (required) {
+            needed[static_cast<unsigned char>(letter)]++;
+            needed_total++;
+        }
+        if (blank)
+            blanks++;
+        else if (from_rack)
+            rack[static_cast<unsigned char>(letter)]++;
+        return more;
+    }
+
+private:
+    string pattern;
+    bool use_rack;
+    size_t min_length;
+    size_t max_length;
+    array<size_t, 256> rack;
+    size_t blanks = 0;
+    array<size_t, 256> needed;
+    size_t needed_total = 0;
+    string word;
+    const function<bool(const string&)>& on_word;
+    const atomic<bool>& stopped;
+
+    // Appends letter to the word. Returns whether it was one of the required letters still missing.
+    bool take(char letter) {
+        word.push_back(letter);
+        unsigned char index = static_cast<unsigned char>(letter);
+        if (needed[index] == 0)
+            return false;
+        needed[index]--;
+        needed_total--;
+        return true;
+    }
+};
+
+void Dictionary::search(const WordQuery& query, const function<bool(const string&)>& on_word) const {
+    atomic<bool> stopped(false);
+    WordSearch(query, on_word, stopped).walk(*root);
+}
+
+void Dictionary::search(const WordQuery& query, ThreadPool& pool, const function<bool(const string&)>& on_word) const {
+    atomic<bool> stopped(false);
+    string prefix = WordSearch(query, on_word, stopped).fixed_prefix();
+    shared_ptr<TrieNode> start = find_prefix(prefix);
+    // a pattern with no '?' names a single word, and a single worker has nothing to share
+    if (start == nullptr || (!prefix.empty() && prefix.size() == query.pattern.size()) || pool.size() <= 1) {
+        if (start != nullptr)
+            search(query, on_word);
+        return;
+    }
+
+    vector<pair<char, const TrieNode*>> subtrees;
+    for (const pair<const char, shared_ptr<TrieNode>>& next : start->nexts) {
+        subtrees.emplace_back(next.first, next.second.get());
+    }
+    mutex on_word_mutex;
+    pool.parallel_for(subtrees.size(), [&](size_t i) {
+        vector<string> batch;
+        // hands the batch on; false once the search has been stopped
+        auto flush = [&] {
+            lock_guard<mutex> lock(on_word_mutex);
+            for (const string& word : batch) {
+                if (stopped.load(memory_order_relaxed) || !on_word(word)) {
+                    stopped.store(true, memory_order_relaxed);
+                    break;
+                }
+            }
+            batch.clear();
+            return !stopped.load(memory_order_relaxed);
+        };
+        function<bool(const string&)> collect = [&](const string& word) {
+            batch.push_back(word);
+            return batch.size() < SEARCH_BATCH || flush();
+        };
+
+        WordSearch subtree(query, collect, stopped);
+        subtree.enter_prefix(prefix);
+        subtree.follow(*subtrees[i].second, subtrees[i].first);
+        flush();
+    });
+}
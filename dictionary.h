@@ -1,12 +1,39 @@
 #ifndef DICTIONARY_H
 #define DICTIONARY_H
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
 #include <unordered_set>
 #include <vector>
 
+class ThreadPool;
+
+/*
+What Dictionary::search looks for. Every part is optional and they all have to hold:
+
+    pattern   one character per letter of the word: a letter matches only itself and '?' any letter, so "?a??ing"
+              finds the seven letter words with an a second and ending in ing. When set, the word is as long as the
+              pattern and the lengths below are ignored.
+    min_length, max_length
+              the lengths a word may have without a pattern.
+    contains  letters the word must have, as many times as they are listed.
+    rack      when use_rack is set, the tiles the word must be built from, with '?' for a blank. Letters fixed by the
+              pattern are taken to be on the board already, so only the '?' squares use tiles; "words fitting this
+              board line" is a pattern with the line's letters and a rack.
+*/
+struct WordQuery {
+    std::string pattern;
+    size_t min_length = 1;
+    size_t max_length = SIZE_MAX;
+    std::string contains;
+    bool use_rack = false;
+    std::string rack;
+};
+
 class Dictionary {
 public:
     struct TrieNode {
@@ -53,6 +80,23 @@ public:
     */
     std::shared_ptr<TrieNode> find_prefix(const std::string& prefix) const;  // Used for testing
 
+    /*
+    Walks the trie for the words matching query, giving up on a branch as soon as no word below it can match the
+    pattern, length, required letters or rack. Each word is passed to on_word as soon as it is found, in alphabetical
+    order; returning false from on_word stops the search.
+    */
+    void search(const WordQuery& query, const std::function<bool(const std::string&)>& on_word) const;
+
+    /*
+    The same search, split over the subtrees below the pattern's fixed first letters and run on the pool. Words are
+    streamed in batches as each subtree finds them, so their order is not fixed, but on_word is only ever called by one
+    thread at a time. Must not be called from inside a job running on the same pool.
+    */
+    void search(
+            const WordQuery& query,
+            ThreadPool& pool,
+            const std::function<bool(const std::string&)>& on_word) const;
+
 private:
     std::shared_ptr<TrieNode> root;
 
@@ -0,0 +1,221 @@
+#include "endgame_solver.h"
+
+#include "computer_player.h"
+#include "rng.h"
+#include "trace.h"
+#include <algorithm>
+#include <climits>
+
+using namespace std;
+
+// the first output of an Rng seeded with z, used to fill the hashing tables
+static uint64_t mix(uint64_t z) { return Rng(z).next(); }
+
+EndgameSolver::EndgameSolver(
+        const ComputerPlayer& generator, const Dictionary& dictionary, const EndgameSettings& settings)
+        : generator(generator), dictionary(dictionary), settings(settings) {}
+
+EndgameResult EndgameSolver::solve(
+        const Board& board, const TileCollection& rack, const TileCollection& opponent_rack) {
+    TraceSpan span("endgame", "solver");
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    deadline = start + settings.time_limit;
+
+    // moves are made and taken back on a copy of the board
+    Board copy(board);
+    this->board = &copy;
+    racks[0] = rack;
+    racks[1] = opponent_rack;
+    board_hash = 0;
+    nodes = 0;
+    aborted = false;
+
+    table.assign(size_t(1) << settings.table_bits, TableEntry());
+    square_keys.resize(board.rows * board.columns * 52);
+    for (size_t i = 0; i < square_keys.size(); ++i) {
+        square_keys[i] = mix(i);
+    }
+    lines.assign(settings.max_depth + 2, vector<PackedMove>());
+
+    // every tile of a line comes from one of the racks, so their points are all that is needed to unpack it
+    TileCollection both_racks = rack;
+    for (TileCollection::const_iterator it = opponent_rack.cbegin(); it != opponent_rack.cend(); it++) {
+        both_racks.add_tile(*it);
+    }
+    TilePoints points(both_racks);
+
+    EndgameResult result;
+    for (size_t depth = 1; depth <= settings.max_depth; ++depth) {
+        reached_horizon = false;
+        may_abort = depth > 1;
+        int value = search(0, depth, -INT_MAX, INT_MAX, 0, 0);
+        if (aborted) {
+            break;
+        }
+
+        result.sequence.clear();
+        for (const PackedMove& move : lines[0]) {
+            result.sequence.push_back(move.unpack(points));
+        }
+        result.spread = value;
+        result.depth = depth;
+        result.solved = !reached_horizon;
+        if (result.solved) {
+            break;
+        }
+    }
+
+    result.nodes = nodes;
+    this->board = nullptr;
+    return result;
+}
+
+// negamax with alpha-beta pruning; returns the spread the side to move gains from here
+int EndgameSolver::search(size_t side, size_t depth, int alpha, int beta, size_t passes, size_t ply) {
+    nodes++;
+    lines[ply].clear();
+    if (may_abort && (chrono::steady_clock::now() >= deadline || is_cancelled())) {
+        aborted = true;
+        return 0;
+    }
+
+    // two passes in a row end the game with both players stuck
+    if (passes >= 2) {
+        return stuck_value(side);
+    }
+    if (depth == 0) {
+        reached_horizon = true;
+        return stuck_value(side);
+    }
+
+    // the transposition table can settle the position, or at least tell us which move to try first
+    uint64_t key = position_key(side, passes);
+    TableEntry& entry = table[key & (table.size() - 1)];
+    uint16_t table_move = NO_MOVE;
+    if (entry.used && entry.key == key) {
+        table_move = entry.best;
+        if (ply > 0 && entry.depth >= depth) {
+            if (entry.bound == Bound::EXACT
+                || (entry.bound == Bound::LOWER && entry.value >= beta)
+                || (entry.bound == Bound::UPPER && entry.value <= alpha)) {
+                return entry.value;
+            }
+        }
+    }
+
+    size_t other = 1 - side;
+    int other_rack_value = racks[other].total_points();
+    size_t rack_size = racks[side].count_tiles();
+
+    // moves that go out end the game at once and are usually best, so they come first, then the rest by score
+    vector<ScoredMove> moves = generator.best_moves(*board, dictionary, racks[side], SIZE_MAX);
+    stable_sort(moves.begin(), moves.end(), [rack_size](const ScoredMove& a, const ScoredMove& b) {
+        bool a_out = a.move.tiles.size() == rack_size;
+        bool b_out = b.move.tiles.size() == rack_size;
+        if (a_out != b_out)
+            return a_out;
+        return a.points > b.points;
+    });
+
+    // the order we try the moves in: the table's move, the rest, and passing last
+    vector<uint16_t> order;
+    if (table_move != NO_MOVE && (table_move == PASS_MOVE || table_move < moves.size()))
+        order.push_back(table_move);
+    for (size_t i = 0; i < moves.size() && i < PASS_MOVE; ++i) {
+        if (i != table_move)
+            order.push_back(i);
+    }
+    if (table_move != PASS_MOVE)
+        order.push_back(PASS_MOVE);
+
+    int original_alpha = alpha;
+    int best_value = -INT_MAX;
+    uint16_t best_move = NO_MOVE;
+    vector<Board::Position> placed;
+
+    for (uint16_t index : order) {
+        int value;
+        if (index == PASS_MOVE) {
+            Move pass;
+            board->place(pass, placed);
+            value = -search(other, depth - 1, -beta, -alpha, passes + 1, ply + 1);
+            board->unplace(pass, placed);
+        } else {
+            const ScoredMove& scored = moves[index];
+            board->place(scored.move, placed);
+            for (size_t i = 0; i < scored.move.tiles.size(); ++i) {
+                racks[side].remove_tile(scored.move.tiles[i]);
+                board_hash ^= tile_key(placed[i], scored.move.tiles[i]);
+            }
+
+            // going out ends the game: the opponent's rack counts against them and for us
+            if (racks[side].count_tiles() == 0) {
+                value = int(scored.points) + 2 * other_rack_value;
+                lines[ply + 1].clear();
+            } else {
+                value = int(scored.points) - search(other, depth - 1, -beta, -alpha, 0, ply + 1);
+            }
+
+            for (size_t i = 0; i < scored.move.tiles.size(); ++i) {
+                racks[side].add_tile(scored.move.tiles[i]);
+                board_hash ^= tile_key(placed[i], scored.move.tiles[i]);
+            }
+            board->unplace(scored.move, placed);
+        }
+        if (aborted) {
+            return 0;
+        }
+
+        if (value > best_value) {
+            best_value = value;
+            best_move = index;
+            lines[ply].clear();
+            lines[ply].push_back(PackedMove::pack(index == PASS_MOVE ? Move() : moves[index].move));
+            lines[ply].insert(lines[ply].end(), lines[ply + 1].begin(), lines[ply + 1].end());
+        }
+        alpha = max(alpha, value);
+        if (alpha >= beta) {
+            break;
+        }
+    }
+
+    entry.used = true;
+    entry.key = key;
+    entry.value = best_value;
+    entry.depth = depth;
+    entry.best = best_move;
+    if (best_value <= original_alpha) {
+        entry.bound = Bound::UPPER;
+    } else if (best_value >= beta) {
+        entry.bound = Bound::LOWER;
+    } else {
+        entry.bound = Bound::EXACT;
+    }
+    return best_value;
+}
+
+// when nobody can go out, each player loses the points left on their own rack
+int EndgameSolver::stuck_value(size_t side) const {
+    return int(racks[1 - side].total_points()) - int(racks[side].total_points());
+}
+
+uint64_t EndgameSolver::position_key(size_t side, size_t passes) const {
+    uint64_t key = board_hash ^ mix(0x51de0000 + side * 4 + passes);
+    for (size_t r = 0; r < 2; ++r) {
+        // the iterator repeats each letter once per copy, and each copy gets its own key
+        char previous = '\0';
+        uint64_t copy = 0;
+        for (TileCollection::const_iterator it = racks[r].cbegin(); it != racks[r].cend(); ++it) {
+            copy = it->letter == previous ? copy + 1 : 0;
+            previous = it->letter;
+            key ^= mix(0x7ac00000 + r * 0x10000 + uint64_t(uint8_t(it->letter)) * 16 + copy);
+        }
+    }
+    return key;
+}
+
+uint64_t EndgameSolver::tile_key(Board::Position position, const TileKind& tile) const {
+    bool blank = tile.letter == TileKind::BLANK_LETTER;
+    size_t letter = size_t((blank ? tile.assigned : tile.letter) - 'a') % 26;
+    return square_keys[(position.row * board->columns + position.column) * 52 + letter + (blank ? 26 : 0)];
+}
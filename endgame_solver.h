@@ -0,0 +1,95 @@
+#ifndef ENDGAME_SOLVER_H
+#define ENDGAME_SOLVER_H
+
+#include "board.h"
+#include "dictionary.h"
+#include "move.h"
+#include "packed_move.h"
+#include "search_limits.h"
+#include "tile_collection.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class ComputerPlayer;
+
+struct EndgameSettings {
+    // Wall-clock time allowed for one solve; the deepest completed search is used when it runs out.
+    // The one ply search always runs to completion, however short the limit.
+    std::chrono::milliseconds time_limit = std::chrono::milliseconds(500);
+    // The most plies searched.
+    size_t max_depth = 14;
+    // The transposition table has 2^table_bits entries.
+    size_t table_bits = 18;
+    // Stops the search like the time limit does when cancelled. May be null.
+    std::shared_ptr<const CancellationToken> cancellation;
+};
+
+struct EndgameResult {
+    // The best line found, starting with the move to make now. Passes are included as PASS moves.
+    std::vector<Move> sequence;
+    // How much the player to move gains on the opponent over the rest of the game along that line.
+    int spread = 0;
+    // The depth of the deepest search that finished in time.
+    size_t depth = 0;
+    // Whether that search reached the end of the game on every line, making the spread exact.
+    bool solved = false;
+    size_t nodes = 0;
+};
+
+/*
+Solves two player endgames, where the bag is empty and so both racks are known.
+
+The solver runs an iterative-deepening negamax search with alpha-beta pruning. Moves are made and taken back on a
+single board, ordered by score with moves that go out first, and the best move found for each position in the last
+iteration is tried first through a transposition table. Positions beyond the search depth are valued as if both
+players were stuck with their racks. Moves are generated by the given ComputerPlayer, so its rules (such as the empty
+hand bonus for its hand size) apply to both sides.
+*/
+class EndgameSolver {
+public:
+    EndgameSolver(const ComputerPlayer& generator, const Dictionary& dictionary, const EndgameSettings& settings);
+
+    EndgameResult solve(const Board& board, const TileCollection& rack, const TileCollection& opponent_rack);
+
+private:
+    enum class Bound : uint8_t { EXACT, LOWER, UPPER };
+
+    struct TableEntry {
+        uint64_t key = 0;
+        int value = 0;
+        uint16_t depth = 0;
+        uint16_t best = NO_MOVE;
+        Bound bound = Bound::EXACT;
+        bool used = false;
+    };
+
+    static constexpr uint16_t NO_MOVE = 0xffff;
+    static constexpr uint16_t PASS_MOVE = 0xfffe;
+
+    const ComputerPlayer& generator;
+    const Dictionary& dictionary;
+    EndgameSettings settings;
+
+    Board* board = nullptr;  // the solve's own copy, which moves are made and taken back on
+    TileCollection racks[2];
+    uint64_t board_hash = 0;
+    std::vector<TableEntry> table;
+    std::vector<uint64_t> square_keys;
+    // lines[ply] is the best line found from ply on, packed because lines are copied whenever a better move is found
+    std::vector<std::vector<PackedMove>> lines;
+    std::chrono::steady_clock::time_point deadline;
+    size_t nodes = 0;
+    bool aborted = false;
+    bool may_abort = false;  // the first iteration always finishes, so there is always a move to return
+    bool reached_horizon = false;
+
+    int search(size_t side, size_t depth, int alpha, int beta, size_t passes, size_t ply);
+    int stuck_value(size_t side) const;
+    bool is_cancelled() const { return settings.cancellation != nullptr && settings.cancellation->is_cancelled(); }
+    uint64_t position_key(size_t side, size_t passes) const;
+    uint64_t tile_key(Board::Position position, const TileKind& tile) const;
+};
+
+#endif
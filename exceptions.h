@@ -23,4 +23,10 @@ public:
     virtual ~CommandException() throw() {}
 };
 
+class JsonException : public std::runtime_error {
+public:
+    JsonException(std::string const& message) : std::runtime_error(message) {}
+    virtual ~JsonException() throw() {}
+};
+
 #endif
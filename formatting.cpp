@@ -1,6 +1,7 @@
 #include "formatting.h"
 
 #include <cstring>
+#include <iomanip>
 
 using namespace std;
 
@@ -22,3 +23,97 @@ void print_horizontal(size_t columns, const char* left, const char* joint, const
     }
     out << repeat(I_HORIZONTAL, SQUARE_INNER_WIDTH) << right << BG_COLOR_OUTSIDE_BOARD;
 }
+
+void print_board(const Board& board, ostream& out) {
+    // Draw horizontal number labels
+    for (size_t i = 0; i < BOARD_TOP_MARGIN - 2; ++i) {
+        out << std::endl;
+    }
+    out << FG_COLOR_LABEL << repeat(SPACE, BOARD_LEFT_MARGIN);
+    const size_t right_number_space = (SQUARE_OUTER_WIDTH - 3) / 2;
+    const size_t left_number_space = (SQUARE_OUTER_WIDTH - 3) - right_number_space;
+    for (size_t column = 0; column < board.columns; ++column) {
+        out << repeat(SPACE, left_number_space) << std::setw(2) << column + 1 << repeat(SPACE, right_number_space);
+    }
+    out << std::endl;
+
+    // Draw top line
+    out << repeat(SPACE, BOARD_LEFT_MARGIN);
+    print_horizontal(board.columns, L_TOP_LEFT, T_DOWN, L_TOP_RIGHT, out);
+    out << endl;
+
+    // Draw inner board
+    for (size_t row = 0; row < board.rows; ++row) {
+        if (row > 0) {
+            out << repeat(SPACE, BOARD_LEFT_MARGIN);
+            print_horizontal(board.columns, T_RIGHT, PLUS, T_LEFT, out);
+            out << endl;
+        }
+
+        // Draw insides of squares
+        for (size_t line = 0; line < SQUARE_INNER_HEIGHT; ++line) {
+            out << FG_COLOR_LABEL << BG_COLOR_OUTSIDE_BOARD;
+
+            // Output column number of left padding
+            if (line == 1) {
+                out << repeat(SPACE, BOARD_LEFT_MARGIN - 3);
+                out << std::setw(2) << row + 1;
+                out << SPACE;
+            } else {
+                out << repeat(SPACE, BOARD_LEFT_MARGIN);
+            }
+
+            // Iterate columns
+            for (size_t column = 0; column < board.columns; ++column) {
+                out << FG_COLOR_LINE << BG_COLOR_NORMAL_SQUARE << I_VERTICAL;
+                const BoardSquare& square = board.square_at(Board::Position(row, column));
+                bool is_start = board.start.row == row && board.start.column == column;
+
+                // Figure out background color
+                if (square.word_multiplier == 2) {
+                    out << BG_COLOR_WORD_MULTIPLIER_2X;
+                } else if (square.word_multiplier == 3) {
+                    out << BG_COLOR_WORD_MULTIPLIER_3X;
+                } else if (square.letter_multiplier == 2) {
+                    out << BG_COLOR_LETTER_MULTIPLIER_2X;
+                } else if (square.letter_multiplier == 3) {
+                    out << BG_COLOR_LETTER_MULTIPLIER_3X;
+                } else if (is_start) {
+                    out << BG_COLOR_START_SQUARE;
+                }
+
+                // Text
+                if (line == 0 && is_start) {
+                    out << "  \u2605  ";
+                } else if (line == 0 && square.word_multiplier > 1) {
+                    out << FG_COLOR_MULTIPLIER << repeat(SPACE, SQUARE_INNER_WIDTH - 2) << 'W' << std::setw(1)
+                        << square.word_multiplier;
+                } else if (line == 0 && square.letter_multiplier > 1) {
+                    out << FG_COLOR_MULTIPLIER << repeat(SPACE, SQUARE_INNER_WIDTH - 2) << 'L' << std::setw(1)
+                        << square.letter_multiplier;
+                } else if (line == 1 && square.has_tile()) {
+                    char l = square.get_tile_kind().letter == TileKind::BLANK_LETTER ? square.get_tile_kind().assigned
+                                                                                     : ' ';
+                    out << repeat(SPACE, 2) << FG_COLOR_LETTER << square.get_tile_kind().letter << l
+                        << repeat(SPACE, 1);
+                } else if (line == SQUARE_INNER_HEIGHT - 1 && square.has_tile()) {
+                    // I fixed this so tht the board would be able to handle double digit letter scores
+                    if (square.get_points() > 9)
+                        out << repeat(SPACE, SQUARE_INNER_WIDTH - 2) << FG_COLOR_SCORE << square.get_points();
+                    else
+                        out << repeat(SPACE, SQUARE_INNER_WIDTH - 1) << FG_COLOR_SCORE << square.get_points();
+                } else {
+                    out << repeat(SPACE, SQUARE_INNER_WIDTH);
+                }
+            }
+
+            // Add vertical line
+            out << FG_COLOR_LINE << BG_COLOR_NORMAL_SQUARE << I_VERTICAL << BG_COLOR_OUTSIDE_BOARD << std::endl;
+        }
+    }
+
+    // Draw bottom line
+    out << repeat(SPACE, BOARD_LEFT_MARGIN);
+    print_horizontal(board.columns, L_BOTTOM_LEFT, T_UP, L_BOTTOM_RIGHT, out);
+    out << endl << rang::style::reset << std::endl;
+}
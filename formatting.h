@@ -1,6 +1,7 @@
 #ifndef FORMATTING_H
 #define FORMATTING_H
 
+#include "board.h"
 #include "rang.h"
 #include <ostream>
 #include <string>
@@ -8,6 +9,10 @@
 std::string repeat(const char* str, size_t times);
 void print_horizontal(size_t columns, const char* left, const char* joint, const char* right, std::ostream& out);
 
+// Draws the board with its premium squares and tiles in terminal colors. Kept out of Board so the engine has no
+// terminal code in it.
+void print_board(const Board& board, std::ostream& out);
+
 // Set colors used in the drawing.
 // Hey, it's like prehistoric CSS!
 
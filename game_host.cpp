@@ -0,0 +1,358 @@
+#include "game_host.h"
+
+#include "analysis.h"
+#include "computer_player.h"
+#include "exceptions.h"
+#include "position_corpus.h"
+#include "rng.h"
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <sstream>
+
+using namespace std;
+
+// the most players a game may have
+static const size_t MAX_PLAYERS = 4;
+
+// what a node of a map or hash table takes besides its value: the links and the allocator's header
+static const size_t NODE_OVERHEAD = 48;
+
+// 2^53: past it, JSON numbers no longer hold every integer
+static const double MAX_EXACT_INTEGER = 9007199254740992.0;
+
+// whether a JSON number is a whole number that converts to an unsigned integer exactly
+static bool is_index(double number) { return number >= 0 && number <= MAX_EXACT_INTEGER && number == floor(number); }
+
+// A player whose moves are sent in by a client, so the game never asks it for one.
+class RemotePlayer : public Player {
+public:
+    RemotePlayer(const string& name, size_t hand_size) : Player(name, hand_size) {}
+
+    Move get_move(const Board& /* board */, const Dictionary& /* dictionary */) const override {
+        throw MoveException("the moves of " + get_name() + " are sent to the host");
+    }
+
+    bool is_human() const override { return true; }
+};
+
+GameHost::GameHost(
+        const Dictionary& dictionary,
+        const Board& empty_board,
+        const TileBag& tile_bag,
+        size_t hand_size,
+        shared_ptr<const LeaveTable> leaves,
+        const GameHostSettings& settings)
+        : dictionary(dictionary),
+          empty_board(empty_board),
+          tile_bag(tile_bag),
+          distribution(tile_bag.to_collection()),
+          hand_size(hand_size),
+          leaves(leaves),
+          settings(settings),
+          bots(settings.bot_threads) {
+    set<char> letters;
+    for (TileCollection::const_iterator it = distribution.cbegin(); it != distribution.cend(); it++) {
+        letters.insert(it->letter);
+    }
+    tile_kinds = letters.size();
+}
+
+string GameHost::handle(const string& request, chrono::steady_clock::time_point received) {
+    string id;
+    string body;
+    try {
+        JsonValue parsed = JsonValue::parse(request);
+        if (parsed.has("id"))
+            id = parsed["id"].dump();
+        if (parsed.type() != JsonValue::Type::OBJECT || !parsed.has("type"))
+            throw JsonException("a request is an object with a type");
+        body = "\"ok\":true," + answer(parsed["type"].as_string(), parsed);
+    } catch (const exception& e) {
+        body = "\"ok\":false,\"error\":" + json_quote(e.what());
+    }
+
+    chrono::duration<double, micro> micros = chrono::steady_clock::now() - received;
+    ostringstream out;
+    out << "{";
+    if (!id.empty())
+        out << "\"id\":" << id << ",";
+    out << body << ",\"micros\":" << llround(micros.count()) << "}";
+    return out.str();
+}
+
+string GameHost::answer(const string& type, const JsonValue& request) {
+    if (type == "create")
+        return create(request);
+    if (type == "state")
+        return state(request);
+    if (type == "validate")
+        return validate(request);
+    if (type == "play")
+        return play(request);
+    if (type == "end")
+        return end(request);
+    if (type == "stats")
+        return stats();
+    throw JsonException("unknown request type " + type);
+}
+
+string GameHost::create(const JsonValue& request) {
+    const vector<JsonValue>& players = request["players"].as_array();
+    if (players.empty() || players.size() > MAX_PLAYERS)
+        throw JsonException("a game has from 1 to " + to_string(MAX_PLAYERS) + " players");
+
+    double seed = request.has("seed") ? request["seed"].as_number() : -1;
+    if (request.has("seed") && !is_index(seed))
+        throw JsonException("a seed is a whole number from 0 to 2^53, not " + request["seed"].dump());
+
+    lock_guard<mutex> games_lock(games_mutex);
+    if (!make_room())
+        throw JsonException("the host is full: " + to_string(settings.max_games) + " games are being played");
+    uint64_t number = next_game++;
+
+    TileBag bag(tile_bag);
+    bag.reseed(request.has("seed") ? uint64_t(seed) : Rng::derive_seed(settings.seed, number));
+    shared_ptr<HostedGame> game = make_shared<HostedGame>(empty_board, bag, dictionary, hand_size);
+    lock_guard<mutex> game_lock(game->game_mutex);
+    for (const JsonValue& player : players) {
+        string name = player["name"].as_string();
+        bool bot = player.has("bot") && player["bot"].as_bool();
+        if (bot) {
+            shared_ptr<ComputerPlayer> computer = make_shared<ComputerPlayer>(name, hand_size, distribution);
+            computer->set_leave_table(leaves);
+            game->state.add_player(computer);
+        } else {
+            game->state.add_player(make_shared<RemotePlayer>(name, hand_size));
+        }
+        game->is_bot.push_back(bot);
+    }
+    games[number] = game;
+    schedule_bots(game);
+    return "\"game\":" + to_string(number);
+}
+
+string GameHost::state(const JsonValue& request) {
+    shared_ptr<HostedGame> game = find(request);
+    lock_guard<mutex> lock(game->game_mutex);
+    const GameState& state = game->state;
+    const vector<shared_ptr<Player>>& players = state.get_players();
+
+    ostringstream out;
+    out << "\"board\":[";
+    vector<string> rows = PositionCorpus::format_board(state.get_board());
+    for (size_t row = 0; row < rows.size(); row++) {
+        out << (row > 0 ? "," : "") << json_quote(rows[row]);
+    }
+    out << "],\"players\":[";
+    for (size_t p = 0; p < players.size(); p++) {
+        out << (p > 0 ? "," : "") << "{\"name\":" << json_quote(players[p]->get_name())
+            << ",\"bot\":" << (game->is_bot[p] ? "true" : "false") << ",\"score\":" << players[p]->get_points()
+            << ",\"tiles\":" << players[p]->count_tiles() << "}";
+    }
+    out << "],\"bag\":" << state.get_tile_bag().count_tiles() << ",\"turns\":" << state.get_turn_count()
+        << ",\"over\":" << (state.is_over() ? "true" : "false");
+    if (!state.is_over())
+        out << ",\"turn\":" << state.current_player_index();
+    if (!state.get_record().turns.empty()) {
+        const GameRecord::Turn& last = state.get_record().turns.back();
+        out << ",\"last\":{\"player\":" << last.player << ",\"move\":" << AnalysisService::move_json(last.move)
+            << ",\"points\":" << last.points << "}";
+    }
+    if (!game->bot_error.empty())
+        out << ",\"bot_error\":" << json_quote(game->bot_error);
+    if (request.has("player")) {
+        double player = request["player"].as_number();
+        if (!is_index(player) || player >= players.size())
+            throw JsonException("the game has no player " + request["player"].dump());
+        out << ",\"rack\":" << json_quote(PositionCorpus::format_rack(players[size_t(player)]->get_tiles()));
+    }
+    return out.str();
+}
+
+string GameHost::validate(const JsonValue& request) {
+    shared_ptr<HostedGame> game = find(request);
+    lock_guard<mutex> lock(game->game_mutex);
+    Move move = read_turn(request, *game);
+    PlaceResult result = game->state.check_move(move);
+    if (!result.valid)
+        return "\"valid\":false,\"reason\":" + json_quote(result.error);
+    unsigned int points = result.points;
+    if (move.kind == MoveKind::PLACE && move.tiles.size() == hand_size)
+        points += GameState::EMPTY_HAND_BONUS;
+    return "\"valid\":true,\"points\":" + to_string(points)
+           + ",\"words\":" + AnalysisService::words_json(result.words);
+}
+
+string GameHost::play(const JsonValue& request) {
+    shared_ptr<HostedGame> game = find(request);
+    lock_guard<mutex> lock(game->game_mutex);
+    Move move = read_turn(request, *game);
+    GameState::TurnResult turn = game->state.apply_move(move);
+    if (game->state.is_over())
+        game->state.finish();
+    game->last_active = chrono::steady_clock::now();
+    schedule_bots(game);
+    return "\"points\":" + to_string(turn.points) + ",\"words\":" + AnalysisService::words_json(turn.words)
+           + ",\"over\":" + (game->state.is_over() ? "true" : "false");
+}
+
+string GameHost::end(const JsonValue& request) {
+    find(request);  // for the error when there is no such game
+    lock_guard<mutex> lock(games_mutex);
+    games.erase(uint64_t(request["game"].as_number()));
+    // a bot still thinking holds on to the game until it is done
+    return "\"ended\":true";
+}
+
+string GameHost::stats() {
+    size_t count;
+    size_t finished = 0;
+    size_t total_bytes = 0;
+    size_t max_bytes = 0;
+    size_t over_budget = 0;
+    {
+        lock_guard<mutex> games_lock(games_mutex);
+        count = games.size();
+        for (const pair<const uint64_t, shared_ptr<HostedGame>>& entry : games) {
+            lock_guard<mutex> game_lock(entry.second->game_mutex);
+            finished += entry.second->state.is_over();
+            size_t bytes = estimate_bytes(*entry.second);
+            total_bytes += bytes;
+            max_bytes = max(max_bytes, bytes);
+            over_budget += bytes > GAME_BYTES_BUDGET;
+        }
+    }
+
+    lock_guard<mutex> lock(counters_mutex);
+    ostringstream out;
+    out << "\"stats\":{\"games\":" << count << ",\"finished\":" << finished << ",\"max_games\":" << settings.max_games
+        << ",\"bytes\":" << total_bytes << ",\"mean_game_bytes\":" << (count == 0 ? 0 : total_bytes / count)
+        << ",\"max_game_bytes\":" << max_bytes << ",\"game_bytes_budget\":" << GAME_BYTES_BUDGET
+        << ",\"over_budget\":" << over_budget << ",\"bot_turns\":" << bot_turns << ",\"bot_errors\":" << bot_errors
+        << ",\"mean_bot_micros\":" << llround(bot_turns == 0 ? 0 : bot_micros / bot_turns) << "}";
+    return out.str();
+}
+
+shared_ptr<GameHost::HostedGame> GameHost::find(const JsonValue& request) {
+    double number = request["game"].as_number();
+    lock_guard<mutex> lock(games_mutex);
+    unordered_map<uint64_t, shared_ptr<HostedGame>>::const_iterator it =
+            is_index(number) ? games.find(uint64_t(number)) : games.end();
+    if (it == games.end())
+        throw JsonException("there is no game " + request["game"].dump());
+    return it->second;
+}
+
+Move GameHost::read_turn(const JsonValue& request, const HostedGame& game) const {
+    if (game.state.is_over())
+        throw MoveException("the game is over");
+    double player = request["player"].as_number();
+    if (player != game.state.current_player_index())
+        throw MoveException("it is not player " + request["player"].dump() + "'s turn");
+    if (game.is_bot[size_t(player)])
+        throw MoveException("the bots play their own moves");
+    return AnalysisService::parse_move(request["move"], empty_board, distribution, hand_size);
+}
+
+bool GameHost::make_room() {
+    if (games.size() < settings.max_games)
+        return true;
+    // the finished game that has waited longest for its players to end it
+    unordered_map<uint64_t, shared_ptr<HostedGame>>::iterator oldest = games.end();
+    for (unordered_map<uint64_t, shared_ptr<HostedGame>>::iterator it = games.begin(); it != games.end(); it++) {
+        lock_guard<mutex> lock(it->second->game_mutex);
+        if (!it->second->state.is_over())
+            continue;
+        if (oldest == games.end() || it->second->last_active < oldest->second->last_active)
+            oldest = it;
+    }
+    if (oldest == games.end())
+        return false;
+    games.erase(oldest);
+    return true;
+}
+
+void GameHost::schedule_bots(const shared_ptr<HostedGame>& game) {
+    if (game->bot_playing || !game->bot_error.empty() || game->state.is_over()
+        || !game->is_bot[game->state.current_player_index()])
+        return;
+    game->bot_playing = true;
+    bots.submit([this, game] { play_bots(game); });
+}
+
+void GameHost::play_bots(shared_ptr<HostedGame> game) {
+    while (true) {
+        Board board = empty_board;
+        shared_ptr<Player> bot;
+        {
+            lock_guard<mutex> lock(game->game_mutex);
+            GameState& state = game->state;
+            if (state.is_over() || !game->is_bot[state.current_player_index()]) {
+                game->bot_playing = false;
+                return;
+            }
+            board = state.get_board();
+            bot = state.get_players()[state.current_player_index()];
+        }
+
+        // nothing else can change the game while it is this bot's turn, so it thinks on a copy of the board unlocked
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        Move move;
+        string error;
+        try {
+            move = bot->get_move(board, dictionary);
+        } catch (const exception& e) {
+            error = e.what();
+        }
+        chrono::duration<double, micro> micros = chrono::steady_clock::now() - start;
+
+        {
+            lock_guard<mutex> lock(game->game_mutex);
+            if (error.empty()) {
+                PlaceResult checked = game->state.check_move(move);
+                if (!checked.valid)
+                    error = "illegal move " + AnalysisService::move_json(move) + ": " + checked.error;
+            }
+            // a bot that cannot move is a bug in the engine, so the game stops with the error rather than going on
+            if (!error.empty()) {
+                game->bot_error = bot->get_name() + ": " + error;
+                game->bot_playing = false;
+                lock_guard<mutex> counters_lock(counters_mutex);
+                bot_errors++;
+                return;
+            }
+            game->state.apply_move(move);
+            if (game->state.is_over())
+                game->state.finish();
+            game->last_active = chrono::steady_clock::now();
+        }
+        lock_guard<mutex> lock(counters_mutex);
+        bot_turns++;
+        bot_micros += micros.count();
+    }
+}
+
+size_t GameHost::estimate_bytes(const HostedGame& game) const {
+    const GameState& state = game.state;
+    const Board& board = state.get_board();
+    size_t bytes = sizeof(HostedGame) + NODE_OVERHEAD;
+    bytes += board.rows * (sizeof(vector<BoardSquare>) + board.columns * sizeof(BoardSquare));
+    bytes += state.get_tile_bag().count_tiles() * sizeof(TileKind) + tile_kinds * (sizeof(TileKind) + NODE_OVERHEAD);
+    for (size_t p = 0; p < state.get_players().size(); p++) {
+        const Player& player = *state.get_players()[p];
+        bytes += (game.is_bot[p] ? sizeof(ComputerPlayer) : sizeof(RemotePlayer)) + NODE_OVERHEAD;
+        bytes += player.get_name().capacity() + player.count_tiles() * (sizeof(TileMap::value_type) + NODE_OVERHEAD);
+        if (game.is_bot[p]) {
+            // the distribution a bot knows, and its tracker's kinds and counts of the unseen tiles
+            bytes += tile_kinds * (sizeof(TileMap::value_type) + NODE_OVERHEAD + sizeof(TileKind) + sizeof(size_t));
+        }
+    }
+    const GameRecord& record = state.get_record();
+    bytes += record.players.size() * sizeof(string) + state.get_players().size() * sizeof(MoveStats);
+    bytes += record.turns.capacity() * sizeof(GameRecord::Turn);
+    for (const GameRecord::Turn& turn : record.turns) {
+        bytes += (turn.rack.capacity() + turn.move.tiles.capacity()) * sizeof(TileKind);
+    }
+    return bytes;
+}
@@ -0,0 +1,121 @@
+#ifndef GAME_HOST_H
+#define GAME_HOST_H
+
+#include "board.h"
+#include "dictionary.h"
+#include "game_state.h"
+#include "json.h"
+#include "leave_table.h"
+#include "thread_pool.h"
+#include "tile_bag.h"
+#include "tile_collection.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct GameHostSettings {
+    size_t max_games = 10000;  // games held at once; finished games are let go first to make room
+    size_t bot_threads = 0;  // workers playing the bots' turns, one per hardware thread when zero
+    uint64_t seed = 0;  // game n's bag is seeded with Rng::derive_seed(seed, n) unless its request gives a seed
+};
+
+/*
+Hosts many games at once, each a GameState of its own, for clients that talk to it in JSON lines like
+AnalysisService:
+
+    {"id": 1, "type": "create", "players": [{"name": "Ann"}, {"name": "Bot", "bot": true}], "seed": 7}
+    {"id": 2, "type": "state", "game": 12, "player": 0}
+    {"id": 3, "type": "validate", "game": 12, "player": 0, "move": {"row": 7, "column": 5, "direction": "across",
+     "tiles": "WoRD"}}
+    {"id": 4, "type": "play", "game": 12, "player": 0, "move": {"kind": "exchange", "tiles": "QV"}}
+    {"id": 5, "type": "end", "game": 12}
+    {"id": 6, "type": "stats"}
+
+create answers the new game's number; its seed, if given, is a whole number up to 2^53 for the bag. state answers the
+board, scores, whose turn it is, the last move and, for a player, their rack. validate checks a move of the player
+whose turn it is and play plays it; moves are written as AnalysisService writes them, with {"kind": "pass"} and
+exchanges too. end lets a game go. stats answers how many games are held and how much memory they take.
+
+A bot that throws or comes up with an illegal move is an engine bug: its game stops there, state reports the error as
+bot_error and stats counts it, instead of the bot passing in its place.
+
+Every game shares the one lexicon, board template and leave table, so a game holds only its board, bag, racks and
+record, and for each bot the distribution and the tiles it has not seen: from about 6 KiB when two people start, or
+11 KiB for two bots, to 18 KiB once two bots finish. GAME_BYTES_BUDGET is what a game is meant to stay under, and stats
+counts the games that do not. Bots play on a pool of their own as soon as it is their turn,
+without holding their game locked while they think, so that clients can keep asking for its state.
+*/
+class GameHost {
+public:
+    static const size_t GAME_BYTES_BUDGET = 24 * 1024;
+
+    // The dictionary and empty board are shared by every game, so they must outlive the host.
+    GameHost(
+            const Dictionary& dictionary,
+            const Board& empty_board,
+            const TileBag& tile_bag,
+            size_t hand_size,
+            std::shared_ptr<const LeaveTable> leaves,
+            const GameHostSettings& settings);
+
+    // Never throws: a request that cannot be answered gets a response with an error.
+    std::string handle(const std::string& request, std::chrono::steady_clock::time_point received);
+
+private:
+    struct HostedGame {
+        std::mutex game_mutex;
+        GameState state;
+        std::vector<bool> is_bot;
+        bool bot_playing = false;  // a bot's turn is on the pool
+        std::string bot_error;  // why a bot could not move, which stops the game
+        std::chrono::steady_clock::time_point last_active;
+
+        HostedGame(const Board& board, const TileBag& bag, const Dictionary& dictionary, size_t hand_size)
+                : state(board, bag, dictionary, hand_size), last_active(std::chrono::steady_clock::now()) {}
+    };
+
+    const Dictionary& dictionary;
+    const Board& empty_board;
+    TileBag tile_bag;
+    TileCollection distribution;
+    size_t hand_size;
+    std::shared_ptr<const LeaveTable> leaves;
+    GameHostSettings settings;
+    size_t tile_kinds;  // distinct tiles in the distribution, for the memory estimate
+
+    std::mutex games_mutex;
+    std::unordered_map<uint64_t, std::shared_ptr<HostedGame>> games;
+    uint64_t next_game = 1;
+
+    std::mutex counters_mutex;
+    size_t bot_turns = 0;
+    size_t bot_errors = 0;
+    double bot_micros = 0;
+
+    // declared last, so that the bots still thinking finish before anything they use goes away
+    ThreadPool bots;
+
+    std::string answer(const std::string& type, const JsonValue& request);
+    std::string create(const JsonValue& request);
+    std::string state(const JsonValue& request);
+    std::string validate(const JsonValue& request);
+    std::string play(const JsonValue& request);
+    std::string end(const JsonValue& request);
+    std::string stats();
+
+    std::shared_ptr<HostedGame> find(const JsonValue& request);
+    Move read_turn(const JsonValue& request, const HostedGame& game) const;
+    // Makes room for a new game if the host is full. Expects games_mutex to be held.
+    bool make_room();
+    // Hands the game to the bots if it is a bot's turn. Expects the game's mutex to be held.
+    void schedule_bots(const std::shared_ptr<HostedGame>& game);
+    void play_bots(std::shared_ptr<HostedGame> game);
+    // What a game takes in memory, from the sizes of the containers it holds. Expects the game's mutex to be held.
+    size_t estimate_bytes(const HostedGame& game) const;
+};
+
+#endif
@@ -0,0 +1,358 @@
+#include "game_record.h"
+
+#include "exceptions.h"
+#include "packed_move.h"
+#include <cctype>
+#include <sstream>
+
+using namespace std;
+
+static const char BINARY_MAGIC[4] = {'S', 'G', 'B', '1'};
+
+// GCG writes racks in upper case with '?' for blanks
+static string rack_string(const vector<TileKind>& tiles) {
+    string letters;
+    for (const TileKind& tile : tiles) {
+        letters += char(toupper(tile.letter));
+    }
+    return letters;
+}
+
+static vector<TileKind> parse_rack(const string& letters, const TileCollection& distribution) {
+    vector<TileKind> tiles;
+    for (char letter : letters) {
+        if (letter == TileKind::BLANK_LETTER || isalpha(letter)) {
+            if (!distribution.has_tile(letter))
+                throw FileException("record has a tile that is not in the distribution: " + string(1, letter));
+            tiles.push_back(distribution.lookup_tile(letter));
+        }
+    }
+    return tiles;
+}
+
+static string nickname(size_t player) { return "p" + to_string(player + 1); }
+
+void GameRecord::write_gcg(ostream& out, const Board& board) const {
+    if (board.columns > 26)
+        throw FileException("GCG cannot name more than 26 columns");
+
+    out << "#character-encoding UTF-8\n";
+    for (size_t p = 0; p < players.size(); p++) {
+        out << "#player" << p + 1 << " " << nickname(p) << " " << players[p] << "\n";
+    }
+
+    // the moves are made on a copy of the board so that we can see which squares each word plays through
+    Board copy(board);
+    for (const Turn& turn : turns) {
+        out << ">" << nickname(turn.player) << ": " << rack_string(turn.rack) << " ";
+        if (turn.move.kind == MoveKind::PASS) {
+            out << "-";
+        } else if (turn.move.kind == MoveKind::EXCHANGE) {
+            out << "-" << rack_string(turn.move.tiles);
+        } else {
+            // the word is written whole, from its first square, with the tiles it plays through before, between
+            // and after the placed ones
+            Direction direction = turn.move.direction;
+            Board::Position square(turn.move.row, turn.move.column);
+            while (copy.in_bounds_and_has_tile(square.translate(direction, -1))) {
+                square = square.translate(direction, -1);
+            }
+
+            string row = to_string(square.row + 1);
+            string column(1, char('A' + square.column));
+            out << (direction == Direction::ACROSS ? row + column : column + row) << " ";
+
+            for (size_t i = 0; i < turn.move.tiles.size() || copy.in_bounds_and_has_tile(square);
+                 square = square.translate(direction)) {
+                if (copy.in_bounds_and_has_tile(square)) {
+                    out << '.';
+                    continue;
+                }
+                const TileKind& tile = turn.move.tiles[i++];
+                out << char(tile.letter == TileKind::BLANK_LETTER ? tolower(tile.assigned) : toupper(tile.letter));
+            }
+        }
+        out << " +" << turn.points << " " << turn.score << "\n";
+        copy.place(turn.move);
+    }
+
+    if (!is_finished())
+        return;
+
+    // the player who went out (if anyone did) gains what is left on the other racks
+    int left = 0;
+    vector<TileKind> all_left;
+    size_t out_player = players.size();
+    for (size_t p = 0; p < players.size(); p++) {
+        if (final_racks[p].empty()) {
+            out_player = p;
+            continue;
+        }
+        int value = 0;
+        for (const TileKind& tile : final_racks[p]) {
+            value += tile.points;
+        }
+        left += value;
+        all_left.insert(all_left.end(), final_racks[p].begin(), final_racks[p].end());
+        string rack = rack_string(final_racks[p]);
+        out << ">" << nickname(p) << ": " << rack << " (" << rack << ") -" << value << " " << final_scores[p] << "\n";
+    }
+    if (out_player < players.size()) {
+        out << ">" << nickname(out_player) << ": (" << rack_string(all_left) << ") +" << left << " "
+            << final_scores[out_player] << "\n";
+    }
+}
+
+vector<GameRecord> GameRecord::read_gcg(istream& in, const TileCollection& distribution) {
+    vector<GameRecord> records;
+    GameRecord record;
+    bool started = false;
+    string line;
+
+    while (getline(in, line)) {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+
+        if (line.compare(0, 7, "#player") == 0) {
+            // a new list of players after some moves starts the next game
+            if (started && !record.turns.empty()) {
+                records.push_back(record);
+                record = GameRecord();
+            }
+            started = true;
+            stringstream ss(line.substr(7));
+            size_t number;
+            string nick;
+            ss >> number >> nick;
+            string name;
+            getline(ss >> ws, name);
+            if (number == 0)
+                throw FileException("bad GCG player line: " + line);
+            if (record.players.size() < number)
+                record.players.resize(number);
+            record.players[number - 1] = name;
+            continue;
+        }
+        if (line.empty() || line[0] != '>')
+            continue;
+
+        stringstream ss(line.substr(1));
+        string nick;
+        ss >> nick;
+        if (nick.size() < 3 || nick[0] != 'p' || nick.back() != ':')
+            throw FileException("bad GCG move line: " + line);
+        size_t player = stoul(nick.substr(1, nick.size() - 2)) - 1;
+        if (player >= record.players.size())
+            throw FileException("GCG move by an unknown player: " + line);
+
+        vector<string> fields;
+        string field;
+        while (ss >> field) {
+            fields.push_back(field);
+        }
+
+        // final subtraction lines are "RACK (RACK) -N SCORE" and "(RACKS) +N SCORE"
+        if ((fields.size() == 3 && fields[0][0] == '(') || (fields.size() == 4 && fields[1][0] == '(')) {
+            if (record.final_scores.empty()) {
+                record.final_scores.assign(record.players.size(), 0);
+                record.final_racks.assign(record.players.size(), vector<TileKind>());
+            }
+            if (fields.size() == 4)
+                record.final_racks[player] = parse_rack(fields[0], distribution);
+            record.final_scores[player] = stoi(fields.back());
+            continue;
+        }
+
+        if (fields.size() < 4)
+            throw FileException("bad GCG move line: " + line);
+        Turn turn;
+        turn.player = player;
+        turn.rack = parse_rack(fields[0], distribution);
+        turn.points = stoul(fields[fields.size() - 2].substr(1));
+        turn.score = stoi(fields.back());
+
+        const string& position = fields[1];
+        if (position == "-") {
+            turn.move = Move();
+        } else if (position[0] == '-') {
+            turn.move = Move(parse_rack(position.substr(1), distribution));
+        } else {
+            if (fields.size() < 5)
+                throw FileException("bad GCG move line: " + line);
+
+            // the row comes first in across moves and the column letter first in down moves
+            Direction direction = isdigit(position[0]) ? Direction::ACROSS : Direction::DOWN;
+            size_t letter_index = direction == Direction::ACROSS ? position.find_first_not_of("0123456789") : 0;
+            if (letter_index == string::npos || !isalpha(position[letter_index]))
+                throw FileException("bad GCG position: " + position);
+            size_t column = toupper(position[letter_index]) - 'A';
+            size_t row = stoul(direction == Direction::ACROSS ? position.substr(0, letter_index) : position.substr(1));
+            if (row == 0)
+                throw FileException("bad GCG position: " + position);
+            Board::Position square(row - 1, column);
+
+            // the word starts at the position, and the move at its first placed tile
+            const string& word = fields[2];
+            size_t first = word.find_first_not_of('.');
+            if (first == string::npos)
+                throw FileException("GCG move places no tiles: " + line);
+            square = square.translate(direction, first);
+            vector<TileKind> tiles;
+            for (char letter : word) {
+                if (letter == '.')
+                    continue;
+                if (islower(letter)) {
+                    tiles.push_back(TileKind(TileKind::BLANK_LETTER, distribution.lookup_tile('?').points, letter));
+                } else {
+                    if (!distribution.has_tile(letter))
+                        throw FileException("record has a tile that is not in the distribution: " + string(1, letter));
+                    tiles.push_back(distribution.lookup_tile(letter));
+                }
+            }
+            turn.move = Move(tiles, square.row, square.column, direction);
+        }
+        record.turns.push_back(turn);
+    }
+
+    if (started)
+        records.push_back(record);
+    return records;
+}
+
+static void write_u8(ostream& out, uint8_t value) { out.put(char(value)); }
+
+static void write_u16(ostream& out, uint16_t value) {
+    out.put(char(value & 0xff));
+    out.put(char(value >> 8));
+}
+
+static void write_tiles(ostream& out, const vector<TileKind>& tiles) {
+    write_u8(out, uint8_t(tiles.size()));
+    for (const TileKind& tile : tiles) {
+        write_u8(out, PackedTile::pack(tile).code);
+    }
+}
+
+void GameRecord::write_binary(ostream& out) const {
+    out.write(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    write_u8(out, uint8_t(players.size()));
+    for (const string& name : players) {
+        write_u8(out, uint8_t(min(name.size(), size_t(255))));
+        out.write(name.data(), min(name.size(), size_t(255)));
+    }
+
+    write_u16(out, uint16_t(turns.size()));
+    for (const Turn& turn : turns) {
+        write_u8(out, uint8_t(turn.player));
+        write_u8(out, uint8_t(turn.move.kind));
+        if (turn.move.kind == MoveKind::PLACE) {
+            write_u8(out, uint8_t(turn.move.row));
+            write_u8(out, uint8_t(turn.move.column));
+            write_u8(out, uint8_t(turn.move.direction));
+        }
+        write_tiles(out, turn.move.tiles);
+        write_tiles(out, turn.rack);
+        write_u16(out, uint16_t(turn.points));
+        write_u16(out, uint16_t(int16_t(turn.score)));
+    }
+
+    write_u8(out, is_finished() ? 1 : 0);
+    if (is_finished()) {
+        for (size_t p = 0; p < players.size(); p++) {
+            write_tiles(out, final_racks[p]);
+            write_u16(out, uint16_t(int16_t(final_scores[p])));
+        }
+    }
+}
+
+// reads the fixed-size fields of a binary record, throwing if the stream ends partway through a game
+class BinaryReader {
+public:
+    explicit BinaryReader(istream& in) : in(in) {}
+
+    uint8_t u8() {
+        int value = in.get();
+        if (value == EOF)
+            throw FileException("binary game record is truncated");
+        return uint8_t(value);
+    }
+
+    uint16_t u16() {
+        uint16_t low = u8();
+        return low | uint16_t(u8()) << 8;
+    }
+
+private:
+    istream& in;
+};
+
+bool GameRecord::read_binary(
+        istream& in, const TileCollection& distribution, const Board& board, GameRecord& record) {
+    char magic[sizeof(BINARY_MAGIC)];
+    if (!in.read(magic, sizeof(magic))) {
+        if (in.gcount() == 0)
+            return false;
+        throw FileException("binary game record is truncated");
+    }
+    if (!equal(magic, magic + sizeof(magic), BINARY_MAGIC))
+        throw FileException("not a binary game record");
+
+    BinaryReader reader(in);
+    TilePoints points(distribution);
+    auto read_tiles = [&](vector<TileKind>& tiles) {
+        uint8_t count = reader.u8();
+        for (uint8_t i = 0; i < count; i++) {
+            try {
+                tiles.push_back(points.unpack(PackedTile{reader.u8()}));
+            } catch (const MoveException&) {
+                throw FileException("binary game record has an unknown tile");
+            }
+        }
+    };
+
+    record = GameRecord();
+    record.players.resize(reader.u8());
+    for (string& name : record.players) {
+        name.resize(reader.u8());
+        for (char& c : name) {
+            c = char(reader.u8());
+        }
+    }
+
+    record.turns.resize(reader.u16());
+    for (Turn& turn : record.turns) {
+        turn.player = reader.u8();
+        MoveKind kind = MoveKind(reader.u8());
+        if (kind == MoveKind::PLACE) {
+            turn.move.kind = MoveKind::PLACE;
+            turn.move.row = reader.u8();
+            turn.move.column = reader.u8();
+            uint8_t direction = reader.u8();
+            if (direction != uint8_t(Direction::ACROSS) && direction != uint8_t(Direction::DOWN))
+                throw FileException("binary game record has an unknown direction");
+            turn.move.direction = Direction(direction);
+            if (!board.is_in_bounds(Board::Position(turn.move.row, turn.move.column)))
+                throw FileException("binary game record has a move off the board");
+        } else if (kind == MoveKind::EXCHANGE || kind == MoveKind::PASS) {
+            turn.move.kind = kind;
+        } else {
+            throw FileException("binary game record has an unknown move kind");
+        }
+        read_tiles(turn.move.tiles);
+        read_tiles(turn.rack);
+        turn.points = reader.u16();
+        turn.score = int16_t(reader.u16());
+        if (turn.player >= record.players.size())
+            throw FileException("binary game record has a move by an unknown player");
+    }
+
+    if (reader.u8()) {
+        record.final_racks.resize(record.players.size());
+        record.final_scores.resize(record.players.size());
+        for (size_t p = 0; p < record.players.size(); p++) {
+            read_tiles(record.final_racks[p]);
+            record.final_scores[p] = int16_t(reader.u16());
+        }
+    }
+    return true;
+}
@@ -0,0 +1,75 @@
+#ifndef GAME_RECORD_H
+#define GAME_RECORD_H
+
+#include "board.h"
+#include "move.h"
+#include "tile_collection.h"
+#include "tile_kind.h"
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/*
+Everything that happened in one game: who played, each player's rack before each move, the moves, and the scores.
+GameState records every game it plays.
+
+Records can be written in two formats:
+
+Text, in the GCG format used by other scrabble programs:
+    #player1 p1 Computer 1
+    >p1: AEFGNPZ 8D FEZ +29 29
+    >p2: EEILOST H4 ST.OLE +24 24
+    >p1: AGNPRUU - +0 29
+    >p2: ABDEEIW -BW +0 24
+    >p1: ENR (ENR) -3 380
+    >p2: (ENR) +3 412
+Across moves give the row before the column letter and down moves the column letter first. Letters placed with a
+blank are lower case and tiles already on the board are dots; the position is the first square of the whole main
+word, which may be a tile already on the board. The last lines give each player's final score after the tiles left on
+the racks are counted.
+
+Binary, for archives of many games: each game starts with the four bytes "SGB1" and stores every tile in one byte
+(see PackedTile), so a turn takes about fifteen bytes.
+
+Tiles are stored by letter only. Reading a record therefore takes the tile distribution, which supplies the points.
+*/
+struct GameRecord {
+    struct Turn {
+        size_t player;
+        std::vector<TileKind> rack;  // the player's tiles before the move
+        Move move;
+        unsigned int points;  // including the empty hand bonus
+        int score;            // the player's total after the move
+    };
+
+    std::vector<std::string> players;
+    std::vector<Turn> turns;
+    // The tiles left on each rack and each player's score after the final subtraction. Empty until the game is over.
+    std::vector<std::vector<TileKind>> final_racks;
+    std::vector<int> final_scores;
+
+    bool is_finished() const { return !final_scores.empty(); }
+
+    /*
+    Writes the record as GCG. The moves are played out on a copy of board, which must be the board the game started
+    with, to find the tiles each word plays through. Throws a FileException if the board is too wide for GCG column
+    letters.
+    */
+    void write_gcg(std::ostream& out, const Board& board) const;
+
+    // Reads every game in a GCG stream. Each "#player1" line after a move starts a new game.
+    static std::vector<GameRecord> read_gcg(std::istream& in, const TileCollection& distribution);
+
+    void write_binary(std::ostream& out) const;
+
+    /*
+    Reads the next game from a binary stream into record. Returns false if the stream has no more games, and throws a
+    FileException if it holds something that is not a complete game, or a move that does not start on board.
+    */
+    static bool read_binary(
+            std::istream& in, const TileCollection& distribution, const Board& board, GameRecord& record);
+};
+
+#endif
@@ -0,0 +1,196 @@
+#include "game_state.h"
+
+#include "exceptions.h"
+#include "trace.h"
+#include <map>
+
+using namespace std;
+
+GameState::GameState(const Board& board, const TileBag& tile_bag, const Dictionary& dictionary, size_t hand_size)
+        : dictionary(dictionary), hand_size(hand_size), board(board), tile_bag(tile_bag) {}
+
+void GameState::add_player(shared_ptr<Player> player) {
+    player->add_tiles(tile_bag.remove_random_tiles(hand_size));
+    players.push_back(player);
+    for (const shared_ptr<Player>& seated : players) {
+        seated->set_player_count(players.size());
+    }
+    record.players.push_back(player->get_name());
+    stats.emplace_back();
+}
+
+bool GameState::is_over() const {
+    // Nobody can move once every player has passed in a row.
+    if (passed_in_row >= players.size())
+        return true;
+
+    // The game also ends as soon as any player has run out of tiles.
+    for (size_t i = 0; i < players.size(); ++i) {
+        if (players[i]->count_tiles() == 0)
+            return true;
+    }
+    return false;
+}
+
+size_t GameState::current_player_index() const { return board.get_move_index() % players.size(); }
+
+Player& GameState::current_player() { return *players[current_player_index()]; }
+
+PlaceResult GameState::check_move(const Move& move) const {
+    const Player& player = *players[current_player_index()];
+
+    // The player must hold every tile used by the move. Blanks are counted together
+    // regardless of the letter assigned to them.
+    map<char, size_t> needed;
+    for (size_t i = 0; i < move.tiles.size(); ++i) {
+        needed[move.tiles[i].letter]++;
+    }
+    for (map<char, size_t>::const_iterator it = needed.begin(); it != needed.end(); ++it) {
+        if (player.get_tiles().count_tiles(TileKind(it->first, 0)) < it->second)
+            return PlaceResult("You do not have the tiles for that move.");
+    }
+
+    if (move.kind == MoveKind::EXCHANGE && tile_bag.count_tiles() < move.tiles.size())
+        return PlaceResult("Not enough tiles in the bag to exchange.");
+
+    PlaceResult result = board.test_place(move);
+    if (!result.valid)
+        return result;
+
+    // test_place() cannot check the dictionary, so we do it here.
+    for (size_t i = 0; i < result.words.size(); ++i) {
+        if (!dictionary.is_word(result.words[i]))
+            return PlaceResult(result.words[i] + " is not a word.");
+    }
+    return result;
+}
+
+GameState::TurnResult GameState::apply_move(const Move& move) {
+    PlaceResult result = check_move(move);
+    if (!result.valid)
+        throw MoveException(result.error);
+
+    TurnResult turn;
+    turn.player_index = current_player_index();
+    turn.move = move;
+    Player& player = *players[turn.player_index];
+
+    GameRecord::Turn recorded;
+    recorded.player = turn.player_index;
+    recorded.move = move;
+    const TileCollection& rack = player.get_tiles();
+    for (TileCollection::const_iterator it = rack.cbegin(); it != rack.cend(); it++) {
+        recorded.rack.push_back(*it);
+    }
+
+    if (move.kind == MoveKind::PASS) {
+        passed_in_row++;
+        board.place(move);
+    } else if (move.kind == MoveKind::EXCHANGE) {
+        // The exchanged tiles go back into the bag before the replacements are drawn.
+        passed_in_row = 0;
+        board.place(move);
+        player.remove_tiles(move.tiles);
+        for (size_t i = 0; i < move.tiles.size(); ++i) {
+            tile_bag.add_tile(move.tiles[i]);
+        }
+        player.add_tiles(tile_bag.remove_random_tiles(move.tiles.size()));
+    } else {
+        passed_in_row = 0;
+        board.place(move);
+        player.remove_tiles(move.tiles);
+        player.add_tiles(tile_bag.remove_random_tiles(move.tiles.size()));
+
+        turn.words = result.words;
+        turn.points = result.points;
+        if (move.tiles.size() == hand_size) {
+            turn.points += EMPTY_HAND_BONUS;
+            turn.empty_hand_bonus = true;
+        }
+        player.add_points(turn.points);
+    }
+
+    recorded.points = turn.points;
+    recorded.score = int(player.get_points());
+    record.turns.push_back(recorded);
+
+    // everyone sees the move, except for which tiles another player exchanged
+    for (size_t i = 0; i < players.size(); ++i) {
+        bool own_move = i == turn.player_index;
+        if (move.kind == MoveKind::EXCHANGE && !own_move) {
+            Move hidden(vector<TileKind>(move.tiles.size(), TileKind(HIDDEN_LETTER, 0)));
+            players[i]->observe_move(hidden, false);
+        } else {
+            players[i]->observe_move(move, own_move);
+        }
+    }
+
+    turn_count++;
+    return turn;
+}
+
+GameState::TurnResult GameState::step() {
+    TraceSpan span("turn", "game");
+    size_t index = current_player_index();
+    MoveStats turn_stats;
+    Move move = players[index]->get_move_with_stats(board, dictionary, turn_stats);
+    TurnResult turn = apply_move(move);
+    turn.stats = turn_stats;
+    stats[index] += turn_stats;
+    return turn;
+}
+
+size_t GameState::play_to_end() {
+    while (!is_over()) {
+        step();
+    }
+    finish();
+    return turn_count;
+}
+
+void GameState::finish() {
+    if (finished)
+        return;
+    final_subtraction(players);
+    finished = true;
+
+    for (size_t i = 0; i < players.size(); ++i) {
+        vector<TileKind> left;
+        const TileCollection& rack = players[i]->get_tiles();
+        for (TileCollection::const_iterator it = rack.cbegin(); it != rack.cend(); it++) {
+            left.push_back(*it);
+        }
+        record.final_racks.push_back(left);
+        record.final_scores.push_back(int(players[i]->get_points()));
+    }
+}
+
+// Performs final score subtraction. Players lose points for each tile in their
+// hand. The player who cleared their hand receives all the points lost by the
+// other players.
+void GameState::final_subtraction(vector<shared_ptr<Player>>& plrs) {
+    // We set up an int to hold how many points the cleared hand player gets
+    // as well as a flag to keep track of if a player has cleared their hand
+    // and an index to save which player it was.
+    int total_lost = 0;
+    bool hand_gone = false;
+    size_t winning_player_index = 0;
+
+    // For each player, we subtract from their points the total value of their hand
+    // and check to see if the player has run out of tiles. We then set the correct
+    // values in lost points and winning index.
+    for (size_t i = 0; i < plrs.size(); ++i) {
+        plrs[i]->subtract_points(plrs[i]->get_hand_value());
+        total_lost += plrs[i]->get_hand_value();
+        if (plrs[i]->count_tiles() == 0) {
+            winning_player_index = i;
+            hand_gone = true;
+        }
+    }
+
+    // If a player has lost their entire hand, we give them all the points
+    // lost by the other players.
+    if (hand_gone) {
+        plrs[winning_player_index]->add_points(total_lost);
+    }
+}
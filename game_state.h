@@ -0,0 +1,106 @@
+#ifndef GAME_STATE_H
+#define GAME_STATE_H
+
+#include "board.h"
+#include "dictionary.h"
+#include "game_record.h"
+#include "move.h"
+#include "move_stats.h"
+#include "place_result.h"
+#include "player.h"
+#include "tile_bag.h"
+#include <memory>
+#include <vector>
+
+/*
+GameState holds everything needed to play one game of scrabble (board, bag, players and whose turn it is) without
+doing any terminal input or output. Scrabble uses it as the engine behind the interactive game, and headless drivers
+use it to play computer games as fast as move generation allows.
+
+The dictionary is shared and never modified, so it is held by reference and must outlive the GameState.
+*/
+class GameState {
+public:
+    static const size_t EMPTY_HAND_BONUS = 50;
+    // The letter of the tiles passed to Player::observe_move() for another player's exchange.
+    static const char HIDDEN_LETTER = '\0';
+
+    // Describes what happened when a move was executed.
+    struct TurnResult {
+        size_t player_index;
+        Move move;
+        std::vector<std::string> words;
+        unsigned int points;  // includes the empty hand bonus
+        bool empty_hand_bonus;
+        MoveStats stats;  // what the player did to find the move, when step() asked for it
+
+        TurnResult() : player_index(0), points(0), empty_hand_bonus(false) {}
+    };
+
+    /*
+    Creates a game from a board and a tile bag. Both are copied, so the same templates can be used to start any
+    number of games.
+    */
+    GameState(const Board& board, const TileBag& tile_bag, const Dictionary& dictionary, size_t hand_size);
+
+    // Adds a player to the game and draws their starting hand from the bag.
+    void add_player(std::shared_ptr<Player> player);
+
+    /*
+    The game is over once a player has emptied their hand, or once every player has passed in a row.
+    */
+    bool is_over() const;
+
+    size_t current_player_index() const;
+    Player& current_player();
+
+    /*
+    Checks whether the current player may execute move. Unlike Board::test_place(), this also checks the words
+    against the dictionary and that the player and bag hold the tiles that the move needs.
+    */
+    PlaceResult check_move(const Move& move) const;
+
+    /*
+    Executes move for the current player: places the tiles, refills the hand from the bag and awards the points.
+    Throws a MoveException if check_move() rejects the move, in which case nothing is changed.
+    */
+    TurnResult apply_move(const Move& move);
+
+    // Asks the current player for a move and executes it, adding what the player did to find it to their stats.
+    TurnResult step();
+
+    // Plays until the game is over and performs the final subtraction. Returns the number of turns played.
+    size_t play_to_end();
+
+    // Performs the final subtraction. Calling it more than once has no further effect.
+    void finish();
+
+    static void final_subtraction(std::vector<std::shared_ptr<Player>>& players);
+
+    size_t get_hand_size() const { return hand_size; }
+    size_t get_turn_count() const { return turn_count; }
+    const Board& get_board() const { return board; }
+    const TileBag& get_tile_bag() const { return tile_bag; }
+    const Dictionary& get_dictionary() const { return dictionary; }
+    const std::vector<std::shared_ptr<Player>>& get_players() const { return players; }
+
+    // Every move so far, with the racks and scores; the final scores are added by finish().
+    const GameRecord& get_record() const { return record; }
+
+    // What a player did to find the moves step() asked it for, added up over the game.
+    const MoveStats& get_stats(size_t player_index) const { return stats[player_index]; }
+
+private:
+    const Dictionary& dictionary;
+    size_t hand_size;
+    Board board;
+    TileBag tile_bag;
+    std::vector<std::shared_ptr<Player>> players;
+    size_t passed_in_row = 0;
+    size_t turn_count = 0;
+    bool finished = false;
+    GameRecord record;
+    std::vector<MoveStats> stats;
+};
+
+#endif
@@ -0,0 +1,57 @@
+#include "computer_player.h"
+#include "game_state.h"
+#include "scrabble_config.h"
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace std;
+
+// Plays computer-versus-computer games with GameState, without any terminal
+// input or output in between, and reports how many games were played per second.
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 4) {
+        cerr << "Usage: " << argv[0] << " <configuration file> [games] [players]" << endl;
+        return 1;
+    }
+    size_t games = argc > 2 ? stoul(argv[2]) : 10;
+    size_t num_players = argc > 3 ? stoul(argv[3]) : 2;
+
+    try {
+        ScrabbleConfig config = ScrabbleConfig::read(argv[1]);
+
+        // The dictionary, board and bag are only read once, and every game starts from copies of them.
+        chrono::steady_clock::time_point load_start = chrono::steady_clock::now();
+        Dictionary dictionary = Dictionary::read(config.dictionary_file_path);
+        Board board = Board::read(config.board_file_path);
+        TileBag tile_bag = TileBag::read(config.tile_bag_file_path, config.seed);
+        chrono::duration<double> load_time = chrono::steady_clock::now() - load_start;
+
+        size_t turns = 0;
+        size_t total_points = 0;
+        chrono::steady_clock::time_point play_start = chrono::steady_clock::now();
+        for (size_t i = 0; i < games; ++i) {
+            tile_bag.reseed(Rng::derive_seed(config.seed, i));
+            GameState game(board, tile_bag, dictionary, config.hand_size);
+            for (size_t p = 0; p < num_players; ++p) {
+                game.add_player(make_shared<ComputerPlayer>("Computer " + to_string(p + 1), config.hand_size));
+            }
+            turns += game.play_to_end();
+            for (size_t p = 0; p < num_players; ++p) {
+                total_points += game.get_players()[p]->get_points();
+            }
+        }
+        chrono::duration<double> play_time = chrono::steady_clock::now() - play_start;
+
+        cout << "loaded in " << load_time.count() << " s\n";
+        cout << games << " games, " << turns << " turns in " << play_time.count() << " s\n";
+        cout << games / play_time.count() << " games/s, " << turns / play_time.count() << " turns/s\n";
+        cout << "average score " << (games * num_players > 0 ? total_points / (games * num_players) : 0) << endl;
+    } catch (const FileException& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -27,7 +27,7 @@ inline string& to_upper(string& str) {
 // to try again with a valid move.
 Move HumanPlayer::get_move(const Board& board, const Dictionary& dictionary) const {
     // Prints the board and hand
-    board.print(cout);
+    print_board(board, cout);
     print_hand(cout);
     cout << endl;
     cout << FG_COLOR_HEADING << "Your move, " << PLAYER_NAME_COLOR << get_name() << FG_COLOR_HEADING << ": "
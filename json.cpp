@@ -0,0 +1,318 @@
+#include "json.h"
+
+#include "exceptions.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace std;
+
+// Nesting deeper than this is refused, so that a hostile request cannot overflow the stack.
+static const size_t MAX_DEPTH = 64;
+
+// A recursive descent parser over the whole text.
+class JsonParser {
+public:
+    explicit JsonParser(const string& text) : text(text) {}
+
+    JsonValue parse() {
+        JsonValue result = value(0);
+        skip_whitespace();
+        if (at != text.size())
+            fail("unexpected text after the value");
+        return result;
+    }
+
+private:
+    const string& text;
+    size_t at = 0;
+
+    [[noreturn]] void fail(const string& message) const {
+        throw JsonException("invalid JSON at offset " + to_string(at) + ": " + message);
+    }
+
+    void skip_whitespace() {
+        while (at < text.size() && (text[at] == ' ' || text[at] == '\t' || text[at] == '\n' || text[at] == '\r'))
+            at++;
+    }
+
+    bool consume(char expected) {
+        skip_whitespace();
+        if (at < text.size() && text[at] == expected) {
+            at++;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char expected) {
+        if (!consume(expected))
+            fail(string("expected '") + expected + "'");
+    }
+
+    bool consume_word(const char* word) {
+        size_t length = string(word).size();
+        if (text.compare(at, length, word) != 0)
+            return false;
+        at += length;
+        return true;
+    }
+
+    JsonValue value(size_t depth) {
+        if (depth > MAX_DEPTH)
+            fail("nested too deeply");
+        skip_whitespace();
+        if (at >= text.size())
+            fail("expected a value");
+
+        JsonValue result;
+        char c = text[at];
+        if (c == '{') {
+            at++;
+            result.kind = JsonValue::Type::OBJECT;
+            if (consume('}'))
+                return result;
+            do {
+                skip_whitespace();
+                if (at >= text.size() || text[at] != '"')
+                    fail("expected a member name");
+                string key = string_literal();
+                expect(':');
+                result.members[key] = value(depth + 1);
+            } while (consume(','));
+            expect('}');
+        } else if (c == '[') {
+            at++;
+            result.kind = JsonValue::Type::ARRAY;
+            if (consume(']'))
+                return result;
+            do {
+                result.items.push_back(value(depth + 1));
+            } while (consume(','));
+            expect(']');
+        } else if (c == '"') {
+            result.kind = JsonValue::Type::STRING;
+            result.text = string_literal();
+        } else if (consume_word("true")) {
+            result.kind = JsonValue::Type::BOOLEAN;
+            result.boolean = true;
+        } else if (consume_word("false")) {
+            result.kind = JsonValue::Type::BOOLEAN;
+        } else if (consume_word("null")) {
+            result.kind = JsonValue::Type::NUL;
+        } else {
+            result.kind = JsonValue::Type::NUMBER;
+            result.number = number_literal();
+        }
+        return result;
+    }
+
+    // the grammar is checked here, and strtod only converts what has been checked
+    double number_literal() {
+        size_t start = at;
+        if (at < text.size() && text[at] == '-')
+            at++;
+        size_t digits = digit_run();
+        if (digits == 0 || (digits > 1 && text[at - digits] == '0'))
+            fail("invalid number");
+        if (at < text.size() && text[at] == '.') {
+            at++;
+            if (digit_run() == 0)
+                fail("invalid number");
+        }
+        if (at < text.size() && (text[at] == 'e' || text[at] == 'E')) {
+            at++;
+            if (at < text.size() && (text[at] == '+' || text[at] == '-'))
+                at++;
+            if (digit_run() == 0)
+                fail("invalid number");
+        }
+        return strtod(text.substr(start, at - start).c_str(), nullptr);
+    }
+
+    size_t digit_run() {
+        size_t start = at;
+        while (at < text.size() && text[at] >= '0' && text[at] <= '9')
+            at++;
+        return at - start;
+    }
+
+    unsigned int hex4() {
+        if (at + 4 > text.size())
+            fail("invalid escape");
+        unsigned int code = 0;
+        for (size_t i = 0; i < 4; i++) {
+            char c = text[at++];
+            code <<= 4;
+            if (c >= '0' && c <= '9')
+                code |= c - '0';
+            else if (c >= 'a' && c <= 'f')
+                code |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F')
+                code |= c - 'A' + 10;
+            else
+                fail("invalid escape");
+        }
+        return code;
+    }
+
+    static void append_utf8(string& out, unsigned int code) {
+        if (code < 0x80) {
+            out += char(code);
+        } else if (code < 0x800) {
+            out += char(0xc0 | (code >> 6));
+            out += char(0x80 | (code & 0x3f));
+        } else if (code < 0x10000) {
+            out += char(0xe0 | (code >> 12));
+            out += char(0x80 | ((code >> 6) & 0x3f));
+            out += char(0x80 | (code & 0x3f));
+        } else {
+            out += char(0xf0 | (code >> 18));
+            out += char(0x80 | ((code >> 12) & 0x3f));
+            out += char(0x80 | ((code >> 6) & 0x3f));
+            out += char(0x80 | (code & 0x3f));
+        }
+    }
+
+    string string_literal() {
+        at++;  // the opening quote
+        string out;
+        while (true) {
+            if (at >= text.size())
+                fail("unterminated string");
+            char c = text[at++];
+            if (c == '"')
+                return out;
+            if (static_cast<unsigned char>(c) < 0x20)
+                fail("control character in string");
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (at >= text.size())
+                fail("unterminated string");
+            char escape = text[at++];
+            if (escape == '"' || escape == '\\' || escape == '/')
+                out += escape;
+            else if (escape == 'b')
+                out += '\b';
+            else if (escape == 'f')
+                out += '\f';
+            else if (escape == 'n')
+                out += '\n';
+            else if (escape == 'r')
+                out += '\r';
+            else if (escape == 't')
+                out += '\t';
+            else if (escape == 'u') {
+                unsigned int code = hex4();
+                // a high surrogate followed by a low one is a single code point outside the basic plane
+                if (code >= 0xd800 && code < 0xdc00 && text.compare(at, 2, "\\u") == 0) {
+                    at += 2;
+                    unsigned int low = hex4();
+                    if (low < 0xdc00 || low >= 0xe000)
+                        fail("invalid surrogate pair");
+                    code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+                }
+                append_utf8(out, code);
+            } else
+                fail("invalid escape");
+        }
+    }
+};
+
+JsonValue JsonValue::parse(const string& text) { return JsonParser(text).parse(); }
+
+bool JsonValue::as_bool() const {
+    if (kind != Type::BOOLEAN)
+        throw JsonException("expected true or false");
+    return boolean;
+}
+
+double JsonValue::as_number() const {
+    if (kind != Type::NUMBER)
+        throw JsonException("expected a number");
+    return number;
+}
+
+const string& JsonValue::as_string() const {
+    if (kind != Type::STRING)
+        throw JsonException("expected a string");
+    return text;
+}
+
+const vector<JsonValue>& JsonValue::as_array() const {
+    if (kind != Type::ARRAY)
+        throw JsonException("expected an array");
+    return items;
+}
+
+const JsonValue& JsonValue::operator[](const string& key) const {
+    static const JsonValue null;
+    if (kind != Type::OBJECT)
+        return null;
+    map<string, JsonValue>::const_iterator it = members.find(key);
+    return it == members.end() ? null : it->second;
+}
+
+bool JsonValue::has(const string& key) const { return kind == Type::OBJECT && members.count(key) > 0; }
+
+string JsonValue::dump() const {
+    switch (kind) {
+    case Type::NUL:
+        return "null";
+    case Type::BOOLEAN:
+        return boolean ? "true" : "false";
+    case Type::NUMBER: {
+        // whole numbers are written without a fraction, so that ids come back as they were sent
+        char buffer[32];
+        if (!isfinite(number))
+            return "null";
+        if (number == floor(number) && fabs(number) < 1e15)
+            snprintf(buffer, sizeof(buffer), "%.0f", number);
+        else
+            snprintf(buffer, sizeof(buffer), "%.17g", number);
+        return buffer;
+    }
+    case Type::STRING:
+        return json_quote(text);
+    case Type::ARRAY: {
+        string out = "[";
+        for (size_t i = 0; i < items.size(); i++) {
+            out += (i > 0 ? "," : "") + items[i].dump();
+        }
+        return out + "]";
+    }
+    case Type::OBJECT: {
+        string out = "{";
+        for (const pair<const string, JsonValue>& member : members) {
+            out += (out.size() > 1 ? "," : "") + json_quote(member.first) + ":" + member.second.dump();
+        }
+        return out + "}";
+    }
+    }
+    return "null";
+}
+
+string json_quote(const string& text) {
+    string out = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (c == '\n') {
+            out += "\\n";
+        } else if (c == '\t') {
+            out += "\\t";
+        } else if (c == '\r') {
+            out += "\\r";
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buffer[8];
+            snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+            out += buffer;
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
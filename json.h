@@ -0,0 +1,58 @@
+#ifndef JSON_H
+#define JSON_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+/*
+A parsed JSON value, for the requests of the analysis tools. Responses are written directly, with json_quote for
+strings. Numbers are kept as doubles, as in JavaScript, and objects keep only the last of repeated keys.
+*/
+class JsonValue {
+public:
+    enum class Type {
+        NUL,
+        BOOLEAN,
+        NUMBER,
+        STRING,
+        ARRAY,
+        OBJECT,
+    };
+
+    JsonValue() : kind(Type::NUL) {}
+
+    // Throws a JsonException if text is not exactly one JSON value, surrounded by nothing but whitespace.
+    static JsonValue parse(const std::string& text);
+
+    Type type() const { return kind; }
+    bool is_null() const { return kind == Type::NUL; }
+
+    // Each throws a JsonException if the value is of another type.
+    bool as_bool() const;
+    double as_number() const;
+    const std::string& as_string() const;
+    const std::vector<JsonValue>& as_array() const;
+
+    // The member called key, or null if there is none or this is not an object.
+    const JsonValue& operator[](const std::string& key) const;
+    bool has(const std::string& key) const;
+
+    // The value written back as compact JSON.
+    std::string dump() const;
+
+private:
+    Type kind;
+    bool boolean = false;
+    double number = 0;
+    std::string text;
+    std::vector<JsonValue> items;
+    std::map<std::string, JsonValue> members;
+
+    friend class JsonParser;
+};
+
+// text as a JSON string, quoted and escaped.
+std::string json_quote(const std::string& text);
+
+#endif
@@ -0,0 +1,77 @@
+#include "leave_table.h"
+
+#include "exceptions.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+
+using namespace std;
+
+LeaveTable LeaveTable::read(const string& file_path) {
+    ifstream file(file_path);
+    if (!file) {
+        throw FileException("cannot open leave file!");
+    }
+
+    LeaveTable table;
+    string letters;
+    double value;
+    while (file >> letters >> value) {
+        transform(letters.begin(), letters.end(), letters.begin(), ::tolower);
+        table.values[index(letters)] = value;
+        if (letters.size() == 1) {
+            table.single_values[tile_code(letters[0])] = value;
+        }
+    }
+    return table;
+}
+
+double LeaveTable::value(const TileCollection& leave) const {
+    unordered_map<uint64_t, double>::const_iterator it = values.find(index(leave));
+    if (it != values.end()) {
+        return it->second;
+    }
+    return fallback_value(leave);
+}
+
+double LeaveTable::value(const string& leave) const {
+    TileCollection tiles;
+    for (char letter : leave) {
+        tiles.add_tile(TileKind(letter, 0));
+    }
+    return value(tiles);
+}
+
+uint64_t LeaveTable::index(const TileCollection& leave) {
+    // The collection is ordered by letter already, so we only have to pack it.
+    uint64_t key = 0;
+    for (TileCollection::const_iterator it = leave.cbegin(); it != leave.cend(); ++it) {
+        key = key << 5 | tile_code(it->letter);
+    }
+    return key;
+}
+
+uint64_t LeaveTable::index(string leave) {
+    sort(leave.begin(), leave.end());
+    uint64_t key = 0;
+    for (char letter : leave) {
+        key = key << 5 | tile_code(letter);
+    }
+    return key;
+}
+
+// Codes start at 1 so that leaves of different lengths never share an index.
+uint64_t LeaveTable::tile_code(char letter) {
+    if (letter == TileKind::BLANK_LETTER) {
+        return 27;
+    }
+    return (tolower(letter) - 'a' + 1) & 31;
+}
+
+double LeaveTable::fallback_value(const TileCollection& leave) const {
+    double sum = 0;
+    for (TileCollection::const_iterator it = leave.cbegin(); it != leave.cend(); ++it) {
+        sum += single_values[tile_code(it->letter)];
+    }
+    return sum;
+}
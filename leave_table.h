@@ -0,0 +1,43 @@
+#ifndef LEAVE_TABLE_H
+#define LEAVE_TABLE_H
+
+#include "tile_collection.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+/*
+Values for the tiles kept on the rack after a move (the "leave"), in points.
+
+A good leave (a blank, an S, a balanced mix of vowels and consonants) makes the next turn score more, so ranking moves
+by points plus the value of their leave plays better than ranking by points alone.
+
+Each line of a leave file holds the letters of a leave followed by its value, e.g. "?s 33.6". Leaves that are not in
+the file are valued as the sum of the values of their single tiles.
+*/
+class LeaveTable {
+public:
+    static LeaveTable read(const std::string& file_path);
+
+    // Returns the value of keeping the given tiles.
+    double value(const TileCollection& leave) const;
+    double value(const std::string& leave) const;
+
+    /*
+    Returns the canonical index of a leave: its tiles in sorted order, packed five bits each. Any two leaves with the
+    same tiles have the same index, however they are ordered.
+    */
+    static uint64_t index(const TileCollection& leave);
+    static uint64_t index(std::string leave);
+
+    size_t size() const { return values.size(); }
+
+private:
+    std::unordered_map<uint64_t, double> values;
+    double single_values[32] = {};
+
+    static uint64_t tile_code(char letter);
+    double fallback_value(const TileCollection& leave) const;
+};
+
+#endif
@@ -26,8 +26,9 @@ struct Move {
     size_t column;
     Direction direction;
 
-    Move() : kind(MoveKind::PASS) {}
-    Move(std::vector<TileKind> tiles) : kind(MoveKind::EXCHANGE), tiles(tiles) {}
+    Move() : kind(MoveKind::PASS), row(0), column(0), direction(Direction::NONE) {}
+    Move(std::vector<TileKind> tiles)
+            : kind(MoveKind::EXCHANGE), tiles(tiles), row(0), column(0), direction(Direction::NONE) {}
     Move(std::vector<TileKind> tiles, size_t row, size_t column, Direction direction)
             : kind(MoveKind::PLACE), tiles(tiles), row(row), column(column), direction(direction) {}
 };
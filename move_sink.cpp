@@ -0,0 +1,88 @@
+#include "move_sink.h"
+
+#include "game_state.h"
+#include "trace.h"
+#include <algorithm>
+
+using namespace std;
+
+void MoveListSink::add(const Move& move, const TileCollection& leave) {
+    (void)leave;  // Suppress unused variable warning.
+    for (const TileKind& tile : move.tiles) {
+        tile_points.add(tile);
+    }
+    moves.push_back(PackedMove::pack(move));
+}
+
+void TopMovesSink::add(const Move& move, const TileCollection& leave) {
+    if (move.tiles.empty() || count == 0)
+        return;
+
+    // exchanges score nothing and are worth only the tiles they keep
+    unsigned int points = 0;
+    if (move.kind == MoveKind::PLACE) {
+        // generation only follows the main word, so the move still has to be placed and
+        // every word it forms has to be in the dictionary
+        PhaseTimer timer(stats.check_time);
+        PlaceResult result = board.test_place(move);
+        if (!result.valid) {
+            MoveStats::count(stats.moves_invalid);
+            return;
+        }
+        for (size_t i = 0; i < result.words.size(); ++i) {
+            if (!dictionary.is_word(result.words[i])) {
+                MoveStats::count(stats.moves_not_words);
+                return;
+            }
+        }
+
+        points = result.points;
+        if (move.tiles.size() == hand_size)
+            points += GameState::EMPTY_HAND_BONUS;
+    }
+    double equity = leaves != nullptr ? points + leaves->value(leave) : points;
+
+    Entry entry{PackedMove(), points, equity, sequence++};
+    if (heap.size() == count && !better(entry, heap.front()))
+        return;
+    entry.move = PackedMove::pack(move);
+
+    // a single tile is found once from each direction, so identical placements are only kept once
+    if (move.kind == MoveKind::PLACE && move.tiles.size() == 1) {
+        for (const Entry& kept : heap) {
+            const PackedMove& other = kept.move;
+            if (other.count == 1 && other.row == entry.move.row && other.column == entry.move.column
+                && other.tiles[0] == entry.move.tiles[0])
+                return;
+        }
+    }
+    for (const TileKind& tile : move.tiles) {
+        tile_points.add(tile);
+    }
+
+    if (heap.size() == count) {
+        pop_heap(heap.begin(), heap.end(), better);
+        heap.pop_back();
+    }
+    heap.push_back(entry);
+    push_heap(heap.begin(), heap.end(), better);
+}
+
+vector<ScoredMove> TopMovesSink::moves() const {
+    TraceSpan span("rank_moves", "search");
+    vector<Entry> sorted(heap);
+    sort(sorted.begin(), sorted.end(), better);
+
+    vector<ScoredMove> output;
+    for (const Entry& entry : sorted) {
+        output.push_back(ScoredMove(entry.move.unpack(tile_points), entry.points, entry.equity));
+    }
+    return output;
+}
+
+// higher equity is better, and of two equal moves the one found first is better
+bool TopMovesSink::better(const Entry& a, const Entry& b) {
+    if (a.equity != b.equity)
+        return a.equity > b.equity;
+    return a.sequence < b.sequence;
+}
@@ -0,0 +1,90 @@
+#ifndef MOVE_SINK_H
+#define MOVE_SINK_H
+
+#include "board.h"
+#include "dictionary.h"
+#include "leave_table.h"
+#include "move.h"
+#include "move_stats.h"
+#include "packed_move.h"
+#include "tile_collection.h"
+#include <vector>
+
+// A legal move together with the points it scores (including the empty hand bonus) and its equity.
+struct ScoredMove {
+    Move move;
+    unsigned int points;
+    // points plus the value of the tiles left on the rack, or just points without a leave table
+    double equity;
+
+    ScoredMove(const Move& move, unsigned int points) : move(move), points(points), equity(points) {}
+    ScoredMove(const Move& move, unsigned int points, double equity) : move(move), points(points), equity(equity) {}
+};
+
+/*
+Receives the moves found by move generation as they are found, together with the tiles that would be left on the
+rack. Generation does not check perpendicular words or the dictionary, so sinks decide what to do with each move.
+Generation counts its work in the sink's stats, and sinks that check moves count what they reject there too.
+*/
+class MoveSink {
+public:
+    MoveStats stats;
+
+    virtual ~MoveSink() {}
+
+    virtual void add(const Move& move, const TileCollection& leave) = 0;
+};
+
+// Keeps every move it is given, unchecked. The moves are packed, so that keeping many of them costs no heap allocation
+// each, and unpacked with tile_points.
+class MoveListSink : public MoveSink {
+public:
+    std::vector<PackedMove> moves;
+    TilePoints tile_points;  // the points of every tile in the moves
+
+    void add(const Move& move, const TileCollection& leave) override;
+};
+
+/*
+Checks each placement with test_place and the dictionary, and keeps the count moves with the highest equity.
+Exchanges are taken as they are, scoring no points. Moves with equal equity are kept in the order they were found.
+Because the leave is handed over by generation, ranking by equity only costs one leave table lookup per valid move.
+The kept moves are packed until moves() hands them out.
+*/
+class TopMovesSink : public MoveSink {
+public:
+    // leaves may be null, in which case moves are ranked by points.
+    TopMovesSink(
+            const Board& board,
+            const Dictionary& dictionary,
+            size_t hand_size,
+            size_t count,
+            const LeaveTable* leaves)
+            : board(board), dictionary(dictionary), hand_size(hand_size), count(count), leaves(leaves) {}
+
+    void add(const Move& move, const TileCollection& leave) override;
+
+    // Returns the kept moves, best first.
+    std::vector<ScoredMove> moves() const;
+
+private:
+    struct Entry {
+        PackedMove move;
+        unsigned int points;
+        double equity;
+        size_t sequence;
+    };
+
+    const Board& board;
+    const Dictionary& dictionary;
+    size_t hand_size;
+    size_t count;
+    const LeaveTable* leaves;
+    std::vector<Entry> heap;  // the worst kept move is at the front
+    TilePoints tile_points;  // the points of every tile in the kept moves
+    size_t sequence = 0;
+
+    static bool better(const Entry& a, const Entry& b);
+};
+
+#endif
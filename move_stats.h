@@ -0,0 +1,83 @@
+#ifndef MOVE_STATS_H
+#define MOVE_STATS_H
+
+#include <chrono>
+#include <cstdint>
+
+// Build with -DSCRABBLE_STATS=0 (make STATS=0) to compile every counter and timer out.
+#ifndef SCRABBLE_STATS
+#define SCRABBLE_STATS 1
+#endif
+
+/*
+What a computer player did to find its moves, phase by phase. Generation hands its counts to the MoveSink it fills,
+ComputerPlayer::search returns them with the moves, and GameState adds up each player's turns over a game.
+
+The generation time covers left_part and extend_right together, including the checking done by the sink as moves
+are found; the check time is that checking on its own.
+*/
+struct MoveStats {
+    static constexpr bool ENABLED = SCRABBLE_STATS;
+
+    uint64_t turns = 0;
+    uint64_t anchors = 0;
+    uint64_t left_part_nodes = 0;     // trie nodes visited while enumerating left parts
+    uint64_t extend_right_nodes = 0;  // trie nodes visited while extending right
+    uint64_t moves_generated = 0;     // placements handed to the sink
+    uint64_t moves_invalid = 0;       // placements rejected by test_place
+    uint64_t moves_not_words = 0;     // placements forming a word that is not in the dictionary
+
+    std::chrono::nanoseconds turn_time{0};
+    std::chrono::nanoseconds anchor_time{0};
+    std::chrono::nanoseconds cross_check_time{0};
+    std::chrono::nanoseconds generation_time{0};
+    std::chrono::nanoseconds check_time{0};
+
+    // Adds n to one of the counters, or does nothing when statistics are compiled out.
+    static void count(uint64_t& counter, uint64_t n = 1) {
+        if constexpr (ENABLED) {
+            counter += n;
+        }
+    }
+
+    MoveStats& operator+=(const MoveStats& other) {
+        turns += other.turns;
+        anchors += other.anchors;
+        left_part_nodes += other.left_part_nodes;
+        extend_right_nodes += other.extend_right_nodes;
+        moves_generated += other.moves_generated;
+        moves_invalid += other.moves_invalid;
+        moves_not_words += other.moves_not_words;
+        turn_time += other.turn_time;
+        anchor_time += other.anchor_time;
+        cross_check_time += other.cross_check_time;
+        generation_time += other.generation_time;
+        check_time += other.check_time;
+        return *this;
+    }
+};
+
+// Adds the time from its construction to its destruction to one of the timers of a MoveStats.
+class PhaseTimer {
+public:
+    explicit PhaseTimer(std::chrono::nanoseconds& total) : total(total) {
+        if constexpr (MoveStats::ENABLED) {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~PhaseTimer() {
+        if constexpr (MoveStats::ENABLED) {
+            total += std::chrono::steady_clock::now() - start;
+        }
+    }
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+    std::chrono::nanoseconds& total;
+    std::chrono::steady_clock::time_point start;
+};
+
+#endif
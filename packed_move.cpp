@@ -0,0 +1,87 @@
+#include "packed_move.h"
+
+#include "exceptions.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+using namespace std;
+
+PackedTile PackedTile::pack(const TileKind& tile) {
+    if (tile.letter == TileKind::BLANK_LETTER) {
+        uint8_t assigned = tile.assigned >= 'a' && tile.assigned <= 'z' ? tile.assigned - 'a' + 1 : 0;
+        return PackedTile{uint8_t(BLANK_FLAG | assigned)};
+    }
+    if (tile.letter < 'a' || tile.letter > 'z')
+        throw MoveException(string("cannot pack tile ") + tile.letter);
+    return PackedTile{uint8_t(tile.letter - 'a' + 1)};
+}
+
+bool operator==(PackedTile lhs, PackedTile rhs) { return lhs.code == rhs.code; }
+
+TilePoints::TilePoints() { fill(begin(table), end(table), 0); }
+
+TilePoints::TilePoints(const TileCollection& distribution) : TilePoints() {
+    for (TileCollection::const_iterator it = distribution.cbegin(); it != distribution.cend(); it++) {
+        add(*it);
+    }
+}
+
+void TilePoints::add(const TileKind& tile) {
+    if (tile.letter >= 'a' && tile.letter <= 'z')
+        table[tile.letter - 'a' + 1] = tile.points;
+    else if (tile.letter == TileKind::BLANK_LETTER)
+        table[0] = tile.points;
+}
+
+unsigned short TilePoints::points(PackedTile tile) const {
+    return table[tile.is_blank() ? 0 : tile.code & PackedTile::LETTER_MASK];
+}
+
+TileKind TilePoints::unpack(PackedTile tile) const {
+    uint8_t letter = tile.code & PackedTile::LETTER_MASK;
+    bool known = (tile.code & ~(PackedTile::BLANK_FLAG | PackedTile::LETTER_MASK)) == 0 && letter <= 26;
+    if (!known || (!tile.is_blank() && letter == 0))
+        throw MoveException("unknown packed tile " + to_string(tile.code));
+    if (tile.is_blank())
+        return TileKind(TileKind::BLANK_LETTER, table[0], tile.assigned());
+    return TileKind(tile.letter(), table[letter]);
+}
+
+PackedMove PackedMove::pack(const Move& move) {
+    if (move.tiles.size() > MAX_TILES)
+        throw MoveException("cannot pack a move of " + to_string(move.tiles.size()) + " tiles");
+
+    // zeroed first, so that equal moves are equal byte for byte
+    PackedMove packed;
+    memset(&packed, 0, sizeof(packed));
+    for (size_t i = 0; i < move.tiles.size(); i++) {
+        packed.tiles[i] = PackedTile::pack(move.tiles[i]);
+    }
+    packed.count = uint8_t(move.tiles.size());
+    packed.kind = uint8_t(move.kind);
+    packed.direction = uint8_t(Direction::NONE);
+    if (move.kind == MoveKind::PLACE) {
+        if (move.row > UINT8_MAX || move.column > UINT8_MAX)
+            throw MoveException("cannot pack a move placed beyond row or column 255");
+        packed.direction = uint8_t(move.direction);
+        packed.row = uint8_t(move.row);
+        packed.column = uint8_t(move.column);
+    }
+    return packed;
+}
+
+Move PackedMove::unpack(const TilePoints& points) const {
+    vector<TileKind> unpacked;
+    unpacked.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        unpacked.push_back(points.unpack(tiles[i]));
+    }
+    if (get_kind() == MoveKind::PLACE)
+        return Move(unpacked, row, column, Direction(direction));
+    if (get_kind() == MoveKind::EXCHANGE)
+        return Move(unpacked);
+    return Move();
+}
+
+bool operator==(const PackedMove& lhs, const PackedMove& rhs) { return memcmp(&lhs, &rhs, sizeof(PackedMove)) == 0; }
@@ -0,0 +1,81 @@
+#ifndef PACKED_MOVE_H
+#define PACKED_MOVE_H
+
+#include "move.h"
+#include "tile_collection.h"
+#include "tile_kind.h"
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+/*
+A tile in one byte. a-z are 1 to 26; a blank sets BLANK_FLAG and keeps the letter it stands for, if any, in the low
+bits, so an unassigned blank is BLANK_FLAG on its own. Points are not stored: they come from a TilePoints table
+built from the tile distribution.
+
+This is also the tile encoding of binary game records.
+*/
+struct PackedTile {
+    uint8_t code;
+
+    static const uint8_t BLANK_FLAG = 0x40;
+    static const uint8_t LETTER_MASK = 0x1f;
+
+    // Throws a MoveException if the tile is not a blank or a letter from a to z.
+    static PackedTile pack(const TileKind& tile);
+
+    bool is_blank() const { return code & BLANK_FLAG; }
+    // The letter on the tile, or TileKind::BLANK_LETTER.
+    char letter() const { return is_blank() ? TileKind::BLANK_LETTER : char('a' + (code & LETTER_MASK) - 1); }
+    // The letter a blank stands for, or '\0' if it is not assigned or not a blank.
+    char assigned() const { return is_blank() && (code & LETTER_MASK) ? char('a' + (code & LETTER_MASK) - 1) : '\0'; }
+};
+
+bool operator==(PackedTile lhs, PackedTile rhs);
+
+// The points of each letter of a tile distribution, for turning packed tiles back into TileKinds.
+class TilePoints {
+public:
+    // An empty table, for adding tiles to as they are seen.
+    TilePoints();
+    explicit TilePoints(const TileCollection& distribution);
+
+    // Records the points of the tile's letter, or of the blank.
+    void add(const TileKind& tile);
+
+    unsigned short points(PackedTile tile) const;
+    // Throws a MoveException if the code is not one PackedTile::pack can produce.
+    TileKind unpack(PackedTile tile) const;
+
+private:
+    // by letter index, with the blank's points at 0
+    unsigned short table[27];
+};
+
+/*
+A Move with its tiles stored inline, so that it can be copied with memcpy and kept in large arrays without a heap
+allocation per move. It holds at most MAX_TILES tiles, which is more than any rack.
+*/
+struct PackedMove {
+    static const size_t MAX_TILES = 11;
+
+    PackedTile tiles[MAX_TILES];
+    uint8_t count;
+    uint8_t kind;       // a MoveKind
+    uint8_t direction;  // a Direction
+    uint8_t row;
+    uint8_t column;
+
+    // Throws a MoveException if the move has more than MAX_TILES tiles or is placed beyond row or column 255.
+    static PackedMove pack(const Move& move);
+
+    MoveKind get_kind() const { return MoveKind(kind); }
+    Move unpack(const TilePoints& points) const;
+};
+
+static_assert(std::is_trivially_copyable<PackedMove>::value, "PackedMove must be copyable with memcpy");
+static_assert(sizeof(PackedMove) == 16, "PackedMove should stay one quarter of a cache line");
+
+bool operator==(const PackedMove& lhs, const PackedMove& rhs);
+
+#endif
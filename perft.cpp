@@ -0,0 +1,167 @@
+#include "computer_player.h"
+#include "dictionary.h"
+#include "exceptions.h"
+#include "position_corpus.h"
+#include "scrabble_config.h"
+#include "tile_bag.h"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// A way of generating every legal placement in a position.
+struct Generator {
+    string name;
+    function<vector<ScoredMove>(const CorpusPosition& position)> generate;
+};
+
+struct GeneratorTotals {
+    size_t moves = 0;
+    double seconds = 0;
+};
+
+void print_usage(const char* program) {
+    cerr << "Usage: " << program << " <configuration file> <corpus file> [--verbose]" << endl;
+    cerr << "Compares every move generator against the reference generator on each position of the corpus." << endl;
+}
+
+/*
+A move as text that is the same however a generator finds it. A single tile forms a word in both directions, and
+which direction it is reported in depends on the generator, so single tiles are written without one.
+*/
+string move_key(const ScoredMove& scored) {
+    const Move& move = scored.move;
+    string key = to_string(move.row) + "," + to_string(move.column) + ",";
+    key += move.tiles.size() == 1 ? '-' : move.direction == Direction::ACROSS ? 'a' : 'd';
+    key += ",";
+    for (const TileKind& tile : move.tiles) {
+        key += tile.letter == TileKind::BLANK_LETTER ? char(toupper(tile.assigned)) : tile.letter;
+    }
+    return key + "," + to_string(scored.points);
+}
+
+// The sorted keys of moves, and how many keys appeared more than once.
+vector<string> move_keys(const vector<ScoredMove>& moves, size_t& duplicates) {
+    vector<string> keys;
+    for (const ScoredMove& scored : moves) {
+        keys.push_back(move_key(scored));
+    }
+    sort(keys.begin(), keys.end());
+    size_t distinct = unique(keys.begin(), keys.end()) - keys.begin();
+    duplicates = keys.size() - distinct;
+    keys.resize(distinct);
+    return keys;
+}
+
+unsigned int best_points(const vector<ScoredMove>& moves) {
+    unsigned int best = 0;
+    for (const ScoredMove& scored : moves) {
+        best = max(best, scored.points);
+    }
+    return best;
+}
+
+/*
+Runs every generator on every position of a corpus, like perft in chess engines: the first generator is the
+reference, and every other one must find exactly the same moves with the same points. Prints the move count and best
+score of each position, every difference from the reference, and the moves per second of each generator. Exits with 2
+if any generator differs.
+*/
+int main(int argc, char** argv) {
+    if (argc < 3 || argc > 4 || (argc == 4 && string(argv[3]) != "--verbose")) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    bool verbose = argc == 4;
+
+    try {
+        ScrabbleConfig config = ScrabbleConfig::read(argv[1]);
+        Dictionary dictionary = Dictionary::read(config.dictionary_file_path);
+        Board board = Board::read(config.board_file_path);
+        TileBag tile_bag = TileBag::read(config.tile_bag_file_path, config.seed);
+        vector<CorpusPosition> positions = PositionCorpus::read(argv[2], board, tile_bag.to_collection());
+
+        ComputerPlayer player("perft", config.hand_size);
+        vector<Generator> generators = {
+                {"reference",
+                 [&](const CorpusPosition& position) {
+                     return player.reference_moves(position.board, dictionary, position.rack);
+                 }},
+                {"cross_checks",
+                 [&](const CorpusPosition& position) {
+                     return player.best_moves(position.board, dictionary, position.rack, SIZE_MAX);
+                 }},
+        };
+
+        vector<GeneratorTotals> totals(generators.size());
+        size_t mismatches = 0;
+        for (const CorpusPosition& position : positions) {
+            vector<string> reference_keys;
+            for (size_t g = 0; g < generators.size(); g++) {
+                chrono::steady_clock::time_point start = chrono::steady_clock::now();
+                vector<ScoredMove> moves = generators[g].generate(position);
+                chrono::duration<double> seconds = chrono::steady_clock::now() - start;
+                totals[g].moves += moves.size();
+                totals[g].seconds += seconds.count();
+
+                size_t duplicates;
+                vector<string> keys = move_keys(moves, duplicates);
+                cout << position.name << " " << generators[g].name << ": moves " << keys.size() << " best "
+                     << best_points(moves);
+                if (duplicates > 0) {
+                    cout << " duplicates " << duplicates;
+                    mismatches++;
+                }
+                cout << '\n';
+
+                if (g == 0) {
+                    reference_keys = keys;
+                    continue;
+                }
+                vector<string> missing;
+                vector<string> extra;
+                set_difference(
+                        reference_keys.begin(),
+                        reference_keys.end(),
+                        keys.begin(),
+                        keys.end(),
+                        back_inserter(missing));
+                set_difference(
+                        keys.begin(), keys.end(), reference_keys.begin(), reference_keys.end(), back_inserter(extra));
+                if (missing.empty() && extra.empty()) {
+                    continue;
+                }
+                mismatches++;
+                cout << position.name << " " << generators[g].name << ": MISMATCH missing " << missing.size()
+                     << " extra " << extra.size() << '\n';
+                if (verbose) {
+                    for (const string& key : missing) {
+                        cout << "  missing " << key << '\n';
+                    }
+                    for (const string& key : extra) {
+                        cout << "  extra " << key << '\n';
+                    }
+                }
+            }
+        }
+
+        cout << fixed << setprecision(3);
+        cout << "positions: " << positions.size() << '\n';
+        for (size_t g = 0; g < generators.size(); g++) {
+            cout << generators[g].name << "_moves: " << totals[g].moves << '\n';
+            cout << generators[g].name << "_seconds: " << totals[g].seconds << '\n';
+            cout << generators[g].name << "_moves_per_second: "
+                 << (totals[g].seconds > 0 ? totals[g].moves / totals[g].seconds : 0) << '\n';
+        }
+        cout << "mismatches: " << mismatches << '\n';
+        return mismatches == 0 ? 0 : 2;
+    } catch (const FileException& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+}
@@ -1,7 +1,5 @@
 #include "player.h"
 
-#include <iostream>
-
 using namespace std;
 
 // add_points simply increments the member variable.
@@ -62,4 +60,7 @@ bool Player::has_tile(TileKind tile) { return (this->tiles.count_tiles(tile)); }
 unsigned int Player::get_hand_value() const { return this->tiles.total_points(); }
 
 // get_hand_size is just a getter for hand size.
-size_t Player::get_hand_size() const { return this->hand_size; }
\ No newline at end of file
+size_t Player::get_hand_size() const { return this->hand_size; }
+
+// get_tiles is just a getter for the player's hand.
+const TileCollection& Player::get_tiles() const { return this->tiles; }
@@ -4,6 +4,7 @@
 #include "board.h"
 #include "dictionary.h"
 #include "move.h"
+#include "move_stats.h"
 #include "tile_collection.h"
 #include <string>
 #include <vector>
@@ -27,9 +28,26 @@ public:
     // Returns a VALID move that can be executed (can be placed, exchanged, or passed).
     virtual Move get_move(const Board& board, const Dictionary& d) const = 0;
 
+    /*
+    Like get_move, and adds what the player did to find the move to stats. Players that keep no statistics leave
+    them as they are.
+    */
+    virtual Move get_move_with_stats(const Board& board, const Dictionary& d, MoveStats& /* stats */) const {
+        return get_move(board, d);
+    }
+
     // Returns whether the player is human
     virtual bool is_human() const = 0;
 
+    /*
+    Called after every move of the game, the player's own included, so that players can keep track of what they
+    have seen. Other players' exchanges are passed with hidden tiles: only their number is public.
+    */
+    virtual void observe_move(const Move& /* move */, bool /* own_move */) {}
+
+    // Called whenever a player joins the game, with the number of players it now has.
+    virtual void set_player_count(size_t /* count */) {}
+
     // Returns the number of tiles in a player's hand.
     size_t count_tiles() const;
 
@@ -47,6 +65,9 @@ public:
 
     size_t get_hand_size() const;
 
+    // Returns the tiles in the player's hand.
+    const TileCollection& get_tiles() const;
+
 protected:
     // TODO: add any protected data members or functions here
     TileCollection tiles;
@@ -0,0 +1,135 @@
+#include "position_corpus.h"
+
+#include "exceptions.h"
+#include <cctype>
+#include <fstream>
+
+using namespace std;
+
+void PositionCorpus::write(ostream& out, const vector<CorpusPosition>& positions) {
+    for (const CorpusPosition& position : positions) {
+        out << "position " << position.name << '\n';
+        out << "rack " << format_rack(position.rack) << '\n';
+        for (const string& row : format_board(position.board)) {
+            out << row << '\n';
+        }
+        out << '\n';
+    }
+}
+
+// the next line that is not blank or a comment, with any trailing carriage return removed
+static bool next_line(istream& in, string& line) {
+    while (getline(in, line)) {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (!line.empty() && line[0] != '#')
+            return true;
+    }
+    return false;
+}
+
+vector<CorpusPosition> PositionCorpus::read(istream& in, const Board& empty_board, const TileCollection& distribution) {
+    vector<CorpusPosition> positions;
+    CorpusPosition position{"", empty_board, TileCollection()};
+    while (read_next(in, empty_board, distribution, position)) {
+        positions.push_back(position);
+    }
+    return positions;
+}
+
+bool PositionCorpus::read_next(
+        istream& in, const Board& empty_board, const TileCollection& distribution, CorpusPosition& position) {
+    string line;
+    if (!next_line(in, line))
+        return false;
+    if (line.compare(0, 9, "position ") != 0)
+        throw FileException("expected a position line in the corpus, not: " + line);
+    string name = line.substr(9);
+
+    if (!next_line(in, line) || line.compare(0, 5, "rack ") != 0)
+        throw FileException("position " + name + " has no rack line");
+    string rack = line.substr(5);
+    vector<string> rows;
+    for (size_t row = 0; row < empty_board.rows && next_line(in, line); row++) {
+        rows.push_back(line);
+    }
+
+    try {
+        position.name = name;
+        position.board = parse_board(rows, empty_board, distribution);
+        position.rack = parse_rack(rack, distribution);
+    } catch (const FileException& e) {
+        throw FileException("position " + name + ": " + e.what());
+    }
+    return true;
+}
+
+char PositionCorpus::format_tile(const TileKind& tile) {
+    if (tile.letter == TileKind::BLANK_LETTER)
+        return char(tolower(tile.assigned));
+    return char(toupper(tile.letter));
+}
+
+string PositionCorpus::format_rack(const TileCollection& rack) {
+    string letters;
+    for (TileCollection::const_iterator it = rack.cbegin(); it != rack.cend(); it++) {
+        letters += char(toupper(it->letter));
+    }
+    return letters;
+}
+
+vector<string> PositionCorpus::format_board(const Board& board) {
+    vector<string> rows;
+    for (size_t row = 0; row < board.rows; row++) {
+        string line;
+        for (size_t column = 0; column < board.columns; column++) {
+            Board::Position square(row, column);
+            line += board.in_bounds_and_has_tile(square) ? format_tile(board.tile_at(square)) : '.';
+        }
+        rows.push_back(line);
+    }
+    return rows;
+}
+
+TileKind PositionCorpus::parse_tile(char letter, const TileCollection& distribution) {
+    if (!isalpha(letter) || !distribution.has_tile(isupper(letter) ? letter : TileKind::BLANK_LETTER))
+        throw FileException(string("tile ") + letter + " is not in the distribution");
+    if (isupper(letter))
+        return distribution.lookup_tile(letter);
+    return TileKind(TileKind::BLANK_LETTER, distribution.lookup_tile(TileKind::BLANK_LETTER).points, letter);
+}
+
+TileCollection PositionCorpus::parse_rack(const string& letters, const TileCollection& distribution) {
+    TileCollection rack;
+    for (char letter : letters) {
+        if (!distribution.has_tile(letter))
+            throw FileException(string("rack tile ") + letter + " is not in the distribution");
+        rack.add_tile(distribution.lookup_tile(letter));
+    }
+    return rack;
+}
+
+Board PositionCorpus::parse_board(
+        const vector<string>& rows, const Board& empty_board, const TileCollection& distribution) {
+    if (rows.size() != empty_board.rows)
+        throw FileException("the board has " + to_string(empty_board.rows) + " rows");
+    Board board(empty_board);
+    for (size_t row = 0; row < rows.size(); row++) {
+        if (rows[row].size() != empty_board.columns)
+            throw FileException("the board has " + to_string(empty_board.columns) + " columns");
+        for (size_t column = 0; column < empty_board.columns; column++) {
+            if (rows[row][column] != '.')
+                board.set_tile(Board::Position(row, column), parse_tile(rows[row][column], distribution));
+        }
+    }
+    return board;
+}
+
+vector<CorpusPosition> PositionCorpus::read(
+        const string& file_path, const Board& empty_board, const TileCollection& distribution) {
+    ifstream file(file_path);
+    if (!file) {
+        throw FileException("cannot open corpus file " + file_path);
+    }
+    return read(file, empty_board, distribution);
+}
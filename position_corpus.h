@@ -0,0 +1,62 @@
+#ifndef POSITION_CORPUS_H
+#define POSITION_CORPUS_H
+
+#include "board.h"
+#include "tile_collection.h"
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// A board and the rack of the player to move.
+struct CorpusPosition {
+    std::string name;
+    Board board;
+    TileCollection rack;
+};
+
+/*
+Reads and writes positions for benchmarks and regression tests, in a text format meant to be diffed and read:
+
+    position game3-turn17
+    rack AEIRST?
+    ...............
+    ...............
+    .......FEZ.....
+    (one line per row of the board)
+
+Board rows use '.' for empty squares, upper case letters for tiles and lower case letters for blanks standing for
+that letter. Racks use upper case letters and '?' for blanks. Blank lines and lines starting with '#' are ignored.
+
+Positions are set up on a copy of the empty board they were taken from, which must have the same size.
+*/
+class PositionCorpus {
+public:
+    static void write(std::ostream& out, const std::vector<CorpusPosition>& positions);
+
+    // Throws a FileException if the stream is not a corpus for this board and distribution.
+    static std::vector<CorpusPosition> read(
+            std::istream& in, const Board& empty_board, const TileCollection& distribution);
+
+    // Reads one position at a time, for corpora too large to hold. Returns false at the end of the stream.
+    static bool read_next(
+            std::istream& in, const Board& empty_board, const TileCollection& distribution, CorpusPosition& position);
+
+    // Like read, from a file.
+    static std::vector<CorpusPosition> read(
+            const std::string& file_path, const Board& empty_board, const TileCollection& distribution);
+
+    /*
+    The pieces of the format, for other tools that describe positions the same way. Each throws a FileException for
+    a tile that is not in the distribution, and parse_board also for rows that do not fit the board.
+    */
+    static char format_tile(const TileKind& tile);
+    static std::string format_rack(const TileCollection& rack);
+    static std::vector<std::string> format_board(const Board& board);
+    static TileKind parse_tile(char letter, const TileCollection& distribution);
+    static TileCollection parse_rack(const std::string& letters, const TileCollection& distribution);
+    static Board parse_board(
+            const std::vector<std::string>& rows, const Board& empty_board, const TileCollection& distribution);
+};
+
+#endif
@@ -0,0 +1,150 @@
+#include "pre_endgame_solver.h"
+
+#include "computer_player.h"
+#include "thread_pool.h"
+#include "trace.h"
+#include <algorithm>
+#include <atomic>
+
+using namespace std;
+
+PreEndgameSolver::PreEndgameSolver(
+        const ComputerPlayer& player, const Dictionary& dictionary, const PreEndgameSettings& settings)
+        : player(player), dictionary(dictionary), settings(settings) {}
+
+PreEndgameResult PreEndgameSolver::solve(
+        const Board& board, const TileCollection& rack, const TileCollection& unseen, size_t bag_size) const {
+    TraceSpan span("pre_endgame", "solver");
+    PreEndgameResult result;
+
+    // passing is a real option here: it can leave the opponent to empty the bag
+    vector<ScoredMove> candidates = player.best_moves(board, dictionary, rack, settings.candidates);
+    candidates.push_back(ScoredMove(Move(), 0));
+
+    vector<Draw> draws;
+    TileCollection remaining(unseen);
+    Draw draw;
+    draw.weight = 1;
+    enumerate_draws(remaining, bag_size, draw, draws);
+
+    // a candidate that places no tiles draws nothing, so every order of the bag gives it the same endgame
+    struct Scenario {
+        size_t candidate;
+        size_t draw;
+    };
+    vector<Scenario> scenarios;
+    for (size_t c = 0; c < candidates.size(); c++) {
+        size_t count = candidates[c].move.tiles.empty() ? 1 : draws.size();
+        for (size_t d = 0; d < count; d++) {
+            scenarios.push_back(Scenario{c, d});
+        }
+    }
+
+    // the turn's time is shared out evenly, with each thread solving its share of the endgames
+    size_t threads = settings.pool != nullptr ? settings.pool->size() : 1;
+    EndgameSettings endgame = settings.endgame;
+    endgame.time_limit = chrono::milliseconds(settings.time_limit.count() * threads / scenarios.size());
+
+    vector<int> values(scenarios.size(), 0);
+    atomic<size_t> nodes(0);
+    auto run_scenario = [&](size_t index) {
+        TraceSpan span("scenario", "solver");
+        size_t scenario_nodes = 0;
+        const Scenario& scenario = scenarios[index];
+        values[index] = evaluate(
+                board,
+                rack,
+                unseen,
+                candidates[scenario.candidate],
+                draws[scenario.draw],
+                endgame,
+                scenario_nodes);
+        nodes += scenario_nodes;
+    };
+
+    if (settings.pool == nullptr) {
+        for (size_t i = 0; i < scenarios.size(); i++) {
+            run_scenario(i);
+        }
+    } else {
+        settings.pool->parallel_for(scenarios.size(), run_scenario);
+    }
+
+    // each candidate's value is its weighted average over the orders of the bag
+    vector<double> value_sum(candidates.size(), 0);
+    vector<double> weight_sum(candidates.size(), 0);
+    for (size_t i = 0; i < scenarios.size(); i++) {
+        double weight = draws[scenarios[i].draw].weight;
+        value_sum[scenarios[i].candidate] += weight * values[i];
+        weight_sum[scenarios[i].candidate] += weight;
+    }
+
+    size_t best = 0;
+    for (size_t c = 1; c < candidates.size(); c++) {
+        if (value_sum[c] / weight_sum[c] > value_sum[best] / weight_sum[best])
+            best = c;
+    }
+
+    result.move = candidates[best].move;
+    result.spread = value_sum[best] / weight_sum[best];
+    result.scenarios = scenarios.size();
+    result.nodes = nodes;
+    return result;
+}
+
+// lists every distinct order of count tiles taken from remaining, weighted by the number of tile orders it stands for
+void PreEndgameSolver::enumerate_draws(TileCollection& remaining, size_t count, Draw& draw, vector<Draw>& draws) {
+    if (draw.tiles.size() == count) {
+        draws.push_back(draw);
+        return;
+    }
+
+    // the iterator repeats each letter once per copy, so only the first copy of each letter is tried
+    vector<TileKind> kinds;
+    for (TileCollection::const_iterator it = remaining.cbegin(); it != remaining.cend(); it++) {
+        if (kinds.empty() || !(kinds.back() == *it))
+            kinds.push_back(*it);
+    }
+
+    for (const TileKind& kind : kinds) {
+        double weight = draw.weight;
+        draw.weight *= remaining.count_tiles(kind);
+        draw.tiles.push_back(kind);
+        remaining.remove_tile(kind);
+
+        enumerate_draws(remaining, count, draw, draws);
+
+        remaining.add_tile(kind);
+        draw.tiles.pop_back();
+        draw.weight = weight;
+    }
+}
+
+int PreEndgameSolver::evaluate(
+        const Board& board,
+        const TileCollection& rack,
+        const TileCollection& unseen,
+        const ScoredMove& candidate,
+        const Draw& draw,
+        const EndgameSettings& endgame,
+        size_t& nodes) const {
+    Board copy(board);
+    copy.place(candidate.move);
+
+    // we refill from the front of the bag, and the opponent ends up with every unseen tile we did not draw
+    TileCollection our_rack(rack);
+    TileCollection opponent_rack(unseen);
+    for (size_t i = 0; i < candidate.move.tiles.size(); i++) {
+        our_rack.remove_tile(candidate.move.tiles[i]);
+    }
+    size_t drawn = min(candidate.move.tiles.size(), draw.tiles.size());
+    for (size_t i = 0; i < drawn; i++) {
+        our_rack.add_tile(draw.tiles[i]);
+        opponent_rack.remove_tile(draw.tiles[i]);
+    }
+
+    EndgameSolver solver(player, dictionary, endgame);
+    EndgameResult reply = solver.solve(copy, opponent_rack, our_rack);
+    nodes = reply.nodes;
+    return int(candidate.points) - reply.spread;
+}
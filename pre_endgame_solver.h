@@ -0,0 +1,98 @@
+#ifndef PRE_ENDGAME_SOLVER_H
+#define PRE_ENDGAME_SOLVER_H
+
+#include "board.h"
+#include "dictionary.h"
+#include "endgame_solver.h"
+#include "move.h"
+#include "move_sink.h"
+#include "tile_collection.h"
+#include <chrono>
+#include <memory>
+#include <vector>
+
+class ComputerPlayer;
+class ThreadPool;
+
+struct PreEndgameSettings {
+    // The solver is used when the bag holds at least one and at most this many tiles.
+    size_t max_bag_tiles = 1;
+    // How many of the player's best moves are compared, besides passing.
+    size_t candidates = 8;
+    // Wall-clock time allowed for the whole turn, shared out between the endgames that are solved.
+    std::chrono::milliseconds time_limit = std::chrono::milliseconds(1000);
+    // Used for each endgame; its time limit is replaced by the endgame's share of the turn.
+    EndgameSettings endgame{std::chrono::milliseconds(0), 6, 14, nullptr};
+    // Threads the endgames are solved on. Zero means one per hardware thread.
+    size_t threads = 0;
+    /*
+    The pool the endgames are solved on, which several players may share. When it is null,
+    ComputerPlayer::enable_pre_endgame_solver starts one of threads workers that lasts as long as the player, unless
+    that is a single thread, in which case the endgames are solved on the calling thread.
+    */
+    std::shared_ptr<ThreadPool> pool;
+};
+
+struct PreEndgameResult {
+    Move move;
+    // The spread expected from the chosen move, averaged over every way the bag could be drawn.
+    double spread = 0;
+    size_t scenarios = 0;
+    size_t nodes = 0;
+};
+
+/*
+Chooses a move for the last turns before the bag empties in a two player game.
+
+The unseen tiles are the opponent's rack plus the few tiles in the bag. Every order the bag could hold the unseen
+tiles in is enumerated (tiles of the same letter are interchangeable, so each distinct order is weighted by how many
+tile orders it stands for). For each candidate move and each order, the player draws from the front of the bag and
+the endgame that follows is solved with the opponent to move. A candidate's value is its points minus the
+opponent's spread in that endgame, averaged over the orders, and the candidate with the best value is chosen.
+
+When a candidate does not empty the bag (passing, or playing fewer tiles than the bag holds) the game is not yet a
+true endgame. The tiles left in the bag are then given to the opponent, who would draw them after its reply.
+
+The candidate × order scenarios are independent and are solved in parallel.
+*/
+class PreEndgameSolver {
+public:
+    PreEndgameSolver(const ComputerPlayer& player, const Dictionary& dictionary, const PreEndgameSettings& settings);
+
+    /*
+    rack: the player's tiles
+    unseen: the tiles the player has not seen, which are the opponent's rack and the bag
+    bag_size: how many of the unseen tiles are in the bag
+    */
+    PreEndgameResult solve(
+            const Board& board, const TileCollection& rack, const TileCollection& unseen, size_t bag_size) const;
+
+private:
+    // One order of the front of the bag and how many tile orders it stands for.
+    struct Draw {
+        std::vector<TileKind> tiles;
+        double weight;
+    };
+
+    const ComputerPlayer& player;
+    const Dictionary& dictionary;
+    PreEndgameSettings settings;
+
+    static void enumerate_draws(
+            TileCollection& remaining, size_t count, Draw& draw, std::vector<Draw>& draws);
+
+    /*
+    Plays candidate, draws from the front of draw and solves the endgame from the opponent's side.
+    Returns the candidate's points minus the opponent's spread.
+    */
+    int evaluate(
+            const Board& board,
+            const TileCollection& rack,
+            const TileCollection& unseen,
+            const ScoredMove& candidate,
+            const Draw& draw,
+            const EndgameSettings& endgame,
+            size_t& nodes) const;
+};
+
+#endif
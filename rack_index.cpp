@@ -0,0 +1,128 @@
+#include "rack_index.h"
+
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+RackIndex::RackIndex(const TileCollection& distribution, size_t max_size) : max_tiles(max_size) {
+    for (TileCollection::const_iterator it = distribution.cbegin(); it != distribution.cend(); it++) {
+        if (kinds.empty() || !(kinds.back() == *it)) {
+            kinds.push_back(*it);
+            limits.push_back(0);
+        }
+        if (limits.back() < max_tiles) {
+            limits.back()++;
+        }
+    }
+
+    // counted in 64 bits so that an alphabet with too many racks is noticed instead of wrapping around; no count is
+    // larger than the total of its size, which is checked below
+    size_t width = max_tiles + 1;
+    vector<uint64_t> wide_ways((letters() + 1) * width, 0);
+    wide_ways[letters() * width] = 1;
+    for (size_t letter = letters(); letter-- > 0;) {
+        for (size_t tiles = 0; tiles <= max_tiles; tiles++) {
+            uint64_t sum = 0;
+            for (size_t count = 0; count <= min<size_t>(limits[letter], tiles); count++) {
+                sum += wide_ways[(letter + 1) * width + tiles - count];
+            }
+            wide_ways[letter * width + tiles] = sum;
+        }
+    }
+
+    offsets.assign(width + 1, 0);
+    uint64_t total = 0;
+    for (size_t tiles = 0; tiles <= max_tiles; tiles++) {
+        total += wide_ways[tiles];
+        if (total > UINT32_MAX) {
+            throw length_error("too many racks of up to " + to_string(max_tiles) + " tiles to index");
+        }
+        offsets[tiles + 1] = uint32_t(total);
+    }
+    ways.assign(wide_ways.begin(), wide_ways.end());
+
+    skipped.assign(letters() * width * width, 0);
+    for (size_t letter = 0; letter < letters(); letter++) {
+        for (size_t tiles = 0; tiles <= max_tiles; tiles++) {
+            uint32_t sum = 0;
+            for (size_t count = 0; count <= tiles; count++) {
+                skipped[(letter * width + tiles) * width + count] = sum;
+                sum += ways_at(letter + 1, tiles - count);
+            }
+        }
+    }
+}
+
+size_t RackIndex::letter_index(char letter) const {
+    for (size_t i = 0; i < kinds.size(); i++) {
+        if (kinds[i].letter == letter) {
+            return i;
+        }
+    }
+    return NO_LETTER;
+}
+
+uint32_t RackIndex::rank(const TileCollection& rack) const {
+    vector<uint8_t> counts(letters(), 0);
+    size_t tiles = 0;
+    // the collection is ordered by letter like the alphabet, so the letters can be matched up in one pass
+    size_t letter = 0;
+    for (TileCollection::const_iterator it = rack.cbegin(); it != rack.cend(); it++) {
+        while (letter < letters() && kinds[letter] < *it) {
+            letter++;
+        }
+        if (letter == letters() || !(kinds[letter] == *it)) {
+            throw out_of_range(string("no tile ") + it->letter + " in the distribution");
+        }
+        if (++counts[letter] > limits[letter] || ++tiles > max_tiles) {
+            throw out_of_range("too many tiles for a rack");
+        }
+    }
+    return rank(counts.data());
+}
+
+uint32_t RackIndex::rank(const uint8_t* counts) const {
+    size_t remaining = 0;
+    for (size_t letter = 0; letter < letters(); letter++) {
+        remaining += counts[letter];
+    }
+
+    uint32_t index = offsets[remaining];
+    for (size_t letter = 0; remaining > 0; letter++) {
+        index += skipped_at(letter, remaining, counts[letter]);
+        remaining -= counts[letter];
+    }
+    return index;
+}
+
+TileCollection RackIndex::unrank(uint32_t index) const {
+    vector<uint8_t> counts(letters());
+    unrank(index, counts.data());
+    TileCollection rack;
+    for (size_t letter = 0; letter < letters(); letter++) {
+        if (counts[letter] > 0) {
+            rack.add_tiles(kinds[letter], counts[letter]);
+        }
+    }
+    return rack;
+}
+
+void RackIndex::unrank(uint32_t index, uint8_t* counts) const {
+    if (index >= size()) {
+        throw out_of_range("rack index " + to_string(index) + " is out of range");
+    }
+    size_t remaining = upper_bound(offsets.begin(), offsets.end(), index) - offsets.begin() - 1;
+    index -= offsets[remaining];
+
+    for (size_t letter = 0; letter < letters(); letter++) {
+        // take as many of this letter as the racks skipped over by taking more still leave index past
+        size_t count = 0;
+        while (count < limits[letter] && count < remaining && skipped_at(letter, remaining, count + 1) <= index) {
+            count++;
+        }
+        index -= skipped_at(letter, remaining, count);
+        counts[letter] = uint8_t(count);
+        remaining -= count;
+    }
+}
@@ -0,0 +1,96 @@
+#ifndef RACK_INDEX_H
+#define RACK_INDEX_H
+
+#include "tile_collection.h"
+#include "tile_kind.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+Numbers every rack that can be drawn from a tile distribution, so that a rack can be used as a dense array index or a
+cache key.
+
+A rack is a multiset of at most max_size tiles with no more of each letter than the distribution holds. Racks are
+ranked by size, and racks of the same size in lexicographic order of their letter counts, with the letters in the
+order the distribution sorts them (the blank first). rank and unrank are inverses, and the racks of each size hold a
+contiguous range of indices, so every rack of a size can be visited by counting through its range.
+
+Internally a rack is an array of counts, one per letter of the alphabet (see letter_index). The TileCollection
+overloads convert to and from that form.
+*/
+class RackIndex {
+public:
+    // Throws std::length_error if there are more racks than a 32-bit index can number.
+    RackIndex(const TileCollection& distribution, size_t max_size);
+
+    static const size_t NO_LETTER = SIZE_MAX;
+
+    size_t letters() const { return kinds.size(); }
+    const TileKind& letter_kind(size_t letter) const { return kinds[letter]; }
+    // The position of a letter in the alphabet, or NO_LETTER if it is not in the distribution.
+    size_t letter_index(char letter) const;
+    size_t max_size() const { return max_tiles; }
+
+    // How many racks there are in all, and how many hold exactly rack_size tiles.
+    uint32_t size() const { return offsets.back(); }
+    uint32_t count(size_t rack_size) const { return offsets[rack_size + 1] - offsets[rack_size]; }
+    // The index of the first rack of rack_size tiles.
+    uint32_t first(size_t rack_size) const { return offsets[rack_size]; }
+
+    // Throws std::out_of_range if the tiles are not a rack of this distribution.
+    uint32_t rank(const TileCollection& rack) const;
+    // counts holds letters() counts that form a rack.
+    uint32_t rank(const uint8_t* counts) const;
+
+    TileCollection unrank(uint32_t index) const;
+    // Fills counts, which must hold letters() entries.
+    void unrank(uint32_t index, uint8_t* counts) const;
+
+    /*
+    Calls visit(index, counts) for every rack of rack_size tiles, in index order. This is faster than unranking each
+    index, since consecutive racks share most of their counts.
+    */
+    template <typename Visit>
+    void for_each(size_t rack_size, Visit visit) const {
+        std::vector<uint8_t> counts(letters(), 0);
+        uint32_t index = first(rack_size);
+        visit_from(0, rack_size, counts.data(), index, visit);
+    }
+
+private:
+    std::vector<TileKind> kinds;
+    std::vector<uint8_t> limits;  // how many of each letter the distribution holds, capped at max_tiles
+    size_t max_tiles;
+    std::vector<uint32_t> ways;     // ways[letter][tiles]: racks of that many tiles made of the letters from letter on
+    std::vector<uint32_t> skipped;  // skipped[letter][tiles][c]: racks passed over by taking c of letter instead of 0
+    std::vector<uint32_t> offsets;  // offsets[size] is first(size), with the total at the end
+
+    uint32_t ways_at(size_t letter, size_t tiles) const { return ways[letter * (max_tiles + 1) + tiles]; }
+    uint32_t skipped_at(size_t letter, size_t tiles, size_t count) const {
+        return skipped[(letter * (max_tiles + 1) + tiles) * (max_tiles + 1) + count];
+    }
+
+    template <typename Visit>
+    void visit_from(size_t letter, size_t remaining, uint8_t* counts, uint32_t& index, Visit& visit) const {
+        if (remaining == 0) {
+            visit(index++, static_cast<const uint8_t*>(counts));
+            return;
+        }
+        if (letter == letters()) {
+            return;
+        }
+        size_t most = std::min<size_t>(limits[letter], remaining);
+        for (size_t count = 0; count <= most; count++) {
+            if (ways_at(letter + 1, remaining - count) == 0) {
+                continue;
+            }
+            counts[letter] = uint8_t(count);
+            visit_from(letter + 1, remaining - count, counts, index, visit);
+        }
+        counts[letter] = 0;
+    }
+};
+
+#endif
@@ -0,0 +1,107 @@
+#include "exceptions.h"
+#include "game_record.h"
+#include "replayer.h"
+#include "scrabble_config.h"
+#include "tile_bag.h"
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+void print_usage(const char* program) {
+    cerr << "Usage: " << program << " <configuration file> [--check-words] [--repeat N] <record file>..." << endl;
+    cerr << "Record files ending in .gcg are read as GCG text, anything else as binary records." << endl;
+}
+
+// reads every game in a record file
+vector<GameRecord> read_records(const string& path, const TileCollection& distribution, const Board& board) {
+    bool gcg = path.size() > 4 && path.compare(path.size() - 4, 4, ".gcg") == 0;
+    ifstream in(path, gcg ? ios::in : ios::in | ios::binary);
+    if (!in) {
+        throw FileException("cannot open record file " + path);
+    }
+    if (gcg) {
+        return GameRecord::read_gcg(in, distribution);
+    }
+
+    vector<GameRecord> records;
+    GameRecord record;
+    while (GameRecord::read_binary(in, distribution, board, record)) {
+        records.push_back(record);
+    }
+    return records;
+}
+
+// Re-executes archived games through Board::place and reports any move that no longer scores what was recorded,
+// along with how many moves per second were replayed.
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    bool check_words = false;
+    size_t repeat = 1;
+    vector<string> paths;
+    for (int i = 2; i < argc; ++i) {
+        string argument = argv[i];
+        if (argument == "--check-words") {
+            check_words = true;
+        } else if (argument == "--repeat" && i + 1 < argc) {
+            repeat = stoul(argv[++i]);
+        } else {
+            paths.push_back(argument);
+        }
+    }
+    if (paths.empty()) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    try {
+        ScrabbleConfig config = ScrabbleConfig::read(argv[1]);
+        Board board = Board::read(config.board_file_path);
+        TileBag tile_bag = TileBag::read(config.tile_bag_file_path, config.seed);
+        // the dictionary takes longer to load than most archives take to replay, so it is only read when needed
+        shared_ptr<Dictionary> dictionary;
+        if (check_words) {
+            dictionary = make_shared<Dictionary>(Dictionary::read(config.dictionary_file_path));
+        }
+
+        vector<GameRecord> records;
+        for (const string& path : paths) {
+            vector<GameRecord> file_records = read_records(path, tile_bag.to_collection(), board);
+            records.insert(records.end(), file_records.begin(), file_records.end());
+        }
+
+        // only the replay is timed, not reading the files
+        Replayer replayer(board, config.hand_size, dictionary.get());
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (size_t r = 0; r < repeat; ++r) {
+            for (const GameRecord& record : records) {
+                replayer.replay(record);
+            }
+        }
+        chrono::duration<double> seconds = chrono::steady_clock::now() - start;
+
+        const ReplayStats& stats = replayer.get_stats();
+        cout << fixed << setprecision(3);
+        cout << "games: " << stats.games << '\n';
+        cout << "moves: " << stats.moves << '\n';
+        cout << "mismatches: " << stats.mismatches << '\n';
+        if (stats.mismatches > 0) {
+            cout << "first_mismatch: " << stats.first_mismatch << '\n';
+        }
+        cout << "seconds: " << seconds.count() << '\n';
+        cout << "moves_per_second: " << (seconds.count() > 0 ? stats.moves / seconds.count() : 0) << '\n';
+        return stats.mismatches == 0 ? 0 : 2;
+    } catch (const FileException& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+}
@@ -0,0 +1,53 @@
+#include "replayer.h"
+
+#include "game_state.h"
+#include <vector>
+
+using namespace std;
+
+bool Replayer::replay(const GameRecord& record) {
+    stats.games++;
+    Board copy(board);
+    vector<int> scores(record.players.size(), 0);
+
+    for (size_t t = 0; t < record.turns.size(); t++) {
+        const GameRecord::Turn& turn = record.turns[t];
+        stats.moves++;
+
+        PlaceResult result = copy.place(turn.move);
+        unsigned int points = 0;
+        if (turn.move.kind == MoveKind::PLACE) {
+            if (!result.valid) {
+                mismatch(t, result.error);
+                return false;
+            }
+            if (dictionary != nullptr) {
+                for (const string& word : result.words) {
+                    if (!dictionary->is_word(word)) {
+                        mismatch(t, word + " is not a word");
+                        return false;
+                    }
+                }
+            }
+            points = result.points;
+            if (turn.move.tiles.size() == hand_size)
+                points += GameState::EMPTY_HAND_BONUS;
+        }
+
+        scores[turn.player] += points;
+        if (points != turn.points || scores[turn.player] != turn.score) {
+            mismatch(t,
+                     "scored " + to_string(points) + " for a total of " + to_string(scores[turn.player])
+                             + " but the record says " + to_string(turn.points) + " for "
+                             + to_string(turn.score));
+            return false;
+        }
+    }
+    return true;
+}
+
+void Replayer::mismatch(size_t turn, const string& reason) {
+    if (stats.mismatches == 0)
+        stats.first_mismatch = "game " + to_string(stats.games) + " turn " + to_string(turn + 1) + ": " + reason;
+    stats.mismatches++;
+}
@@ -0,0 +1,45 @@
+#ifndef REPLAYER_H
+#define REPLAYER_H
+
+#include "board.h"
+#include "dictionary.h"
+#include "game_record.h"
+#include <string>
+
+struct ReplayStats {
+    size_t games = 0;
+    size_t moves = 0;
+    size_t mismatches = 0;
+    // Describes the first move that did not match its record, if any did.
+    std::string first_mismatch;
+};
+
+/*
+Re-executes recorded games move by move through Board::place() and checks that every placement is still legal and
+scores what the record says, and that the running scores add up. With a dictionary, the words formed are checked
+too. This catches any change to placement or scoring that alters the outcome of archived games, and doubles as a
+fast way to turn archives back into board positions.
+
+A game stops being replayed at its first mismatch, since the board no longer matches the record after it.
+*/
+class Replayer {
+public:
+    // board: the board every game starts from. dictionary may be null to skip checking words.
+    Replayer(const Board& board, size_t hand_size, const Dictionary* dictionary = nullptr)
+            : board(board), hand_size(hand_size), dictionary(dictionary) {}
+
+    // Replays one game and returns whether every move matched. The results are added to the stats.
+    bool replay(const GameRecord& record);
+
+    const ReplayStats& get_stats() const { return stats; }
+
+private:
+    const Board& board;
+    size_t hand_size;
+    const Dictionary* dictionary;
+    ReplayStats stats;
+
+    void mismatch(size_t turn, const std::string& reason);
+};
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+/*
+A small, fast random number generator (SplitMix64) that can be split into independent streams.
+
+Every random choice in the engine comes from an Rng, and every Rng is derived from a seed and the identifiers of what
+it is for (a game index, a move number, a playout index, ...). A stream therefore only depends on those identifiers
+and never on which thread runs it or what ran before it on that thread, which keeps parallel runs bit-for-bit
+reproducible whatever the number of threads.
+
+The helpers below (below, uniform, shuffle, pick) are written out instead of using the standard distributions, whose
+results differ between standard library implementations.
+*/
+class Rng {
+public:
+    typedef uint64_t result_type;
+
+    explicit Rng(uint64_t seed = 0) : state(seed) {}
+
+    // A stream for one purpose, derived from a seed and an identifier. Nesting calls derives streams from several.
+    static Rng derive(uint64_t seed, uint64_t stream) { return Rng(mix(mix(seed) ^ (stream * STREAM_MULTIPLIER))); }
+
+    // A stream derived from this generator's current state without advancing it.
+    Rng split(uint64_t stream) const { return derive(state, stream); }
+
+    // The seed that derive() would start from, for when a stream has to be passed on as a number.
+    static uint64_t derive_seed(uint64_t seed, uint64_t stream) { return derive(seed, stream).state; }
+
+    uint64_t next() {
+        state += GOLDEN_GAMMA;
+        return mix(state);
+    }
+
+    // A uniformly distributed integer in [0, bound), without modulo bias. bound must not be zero.
+    uint64_t below(uint64_t bound) {
+        // Lemire's multiply-and-shift, rejecting the few low products that would favour some results
+        __uint128_t product = __uint128_t(next()) * bound;
+        uint64_t low = uint64_t(product);
+        if (low < bound) {
+            uint64_t threshold = (0 - bound) % bound;
+            while (low < threshold) {
+                product = __uint128_t(next()) * bound;
+                low = uint64_t(product);
+            }
+        }
+        return uint64_t(product >> 64);
+    }
+
+    // A uniformly distributed double in [0, 1).
+    double uniform() { return (next() >> 11) * (1.0 / (uint64_t(1) << 53)); }
+
+    // Shuffles [first, last) with Fisher-Yates.
+    template <typename Iterator>
+    void shuffle(Iterator first, Iterator last) {
+        size_t count = last - first;
+        for (size_t i = count; i > 1; i--) {
+            std::swap(first[i - 1], first[below(i)]);
+        }
+    }
+
+    // Picks an index with probability proportional to its weight. The weights must not all be zero.
+    template <typename Weights>
+    size_t pick(const Weights& weights) {
+        double total = 0;
+        for (double weight : weights) {
+            total += weight;
+        }
+        double target = uniform() * total;
+        size_t index = 0;
+        for (double weight : weights) {
+            if (target < weight)
+                return index;
+            target -= weight;
+            index++;
+        }
+        return weights.size() - 1;
+    }
+
+    // The SplitMix64 output function, also useful on its own as a 64-bit hash.
+    static uint64_t mix(uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    // So that an Rng can be used where the standard library wants a random bit generator.
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT64_MAX; }
+    result_type operator()() { return next(); }
+
+private:
+    static constexpr uint64_t GOLDEN_GAMMA = 0x9e3779b97f4a7c15ULL;
+    static constexpr uint64_t STREAM_MULTIPLIER = 0xd1b54a32d192ed03ULL;
+
+    uint64_t state;
+};
+
+#endif
@@ -11,121 +11,57 @@ using namespace std;
 Scrabble::Scrabble(const ScrabbleConfig& config)
         : hand_size(config.hand_size),
           minimum_word_length(config.minimum_word_length),
-          tile_bag(TileBag::read(config.tile_bag_file_path, config.seed)),
-          board(Board::read(config.board_file_path)),
-          dictionary(Dictionary::read(config.dictionary_file_path)) {}
+          dictionary(Dictionary::read(config.dictionary_file_path)),
+          leaves(config.leave_file_path.empty() ? nullptr
+                                                : make_shared<LeaveTable>(LeaveTable::read(config.leave_file_path))),
+          game(Board::read(config.board_file_path),
+               TileBag::read(config.tile_bag_file_path, config.seed),
+               dictionary,
+               config.hand_size),
+          distribution(game.get_tile_bag().to_collection()) {}
 
 // Game Loop should cycle through players and get and execute that players move
-// until the game is over.
-void Scrabble::game_loop() {
-    // We initialize some variables to keep track of when we should end the game
-    size_t passed_in_row = 0;
-    bool all_players_have_tiles = true;
-
+// until the game is over. All of the rules live in GameState; this loop only
+// shows the board, asks for moves and reports what happened.
+// Returns false if the game was stopped because a computer player made an illegal move.
+bool Scrabble::game_loop() {
     // We clear the string stream for our first move.
     cin.ignore(numeric_limits<streamsize>::max(), '\n');
 
-    // We want to keep getting moves from the players until either all players have
-    // passed in a row or one of the players is out of tiles.
-    while (passed_in_row < (this->players.size() - non_human_players) && all_players_have_tiles) {
-        // We get the current player's index based on the number of moves that have occured.
-        size_t p = board.get_move_index() % this->players.size();
-
-        // We get the move from the curent player and test the place result with it.
-        if (players[p]->is_human()) {
-            Move curr_move = players[p]->get_move(board, dictionary);
-            PlaceResult result = board.test_place(curr_move);
-
-            // If we got an invalid place result, we ask the user to give us a correct one.
-            while (!result.valid) {
-                cout << "Error in move: " << result.error << endl << endl;
-                curr_move = players[p]->get_move(board, dictionary);
-                result = board.test_place(curr_move);
-            }
+    while (!game.is_over()) {
+        Player& player = game.current_player();
 
-            if (curr_move.kind == MoveKind::PASS) {
-                // If the move is pass, we increment the turn index and passed in row variable,
-                // and output our generic output.
-                board.place(curr_move);
-                if (players[p]->is_human())
-                    passed_in_row++;
-                cout << "Your current score: " << SCORE_COLOR << players[p]->get_points() << rang::style::reset << endl;
-                cout << "Press [enter] to confirm." << endl;
-                cin.ignore(numeric_limits<streamsize>::max(), '\n');
-            } else if (curr_move.kind == MoveKind::EXCHANGE) {
-                // If the move is exchange, we increment the turn index, remove the tiles from the player's
-                // collection, add them back to the bag, and replace the missing tiles with random ones
-                // from the bag.
-                // We also set pass_in_row back to zero.
-                board.place(curr_move);
-                passed_in_row = 0;
-                players[p]->remove_tiles(curr_move.tiles);
-                for (size_t n = 0; n < curr_move.tiles.size(); ++n) {
-                    tile_bag.add_tile(curr_move.tiles[n]);
-                }
-                vector<TileKind> draw = tile_bag.remove_random_tiles(curr_move.tiles.size());
-                players[p]->add_tiles(draw);
-
-                // We output our generic output.
-                cout << "Your current score: " << SCORE_COLOR << players[p]->get_points() << rang::style::reset << endl;
-                cout << "Press [enter] to confirm." << endl;
-                cin.ignore(numeric_limits<streamsize>::max(), '\n');
-            } else if (curr_move.kind == MoveKind::PLACE) {
-                // If the move is place, we place the move and remove the used tiles from the player's hand.
-                // We also set pass_in_row back to zero and refill the players hand with random tiles.
-                // Finally, we print out the number of points gained and the generic output.
-                passed_in_row = 0;
-                board.place(curr_move);
-                players[p]->remove_tiles(curr_move.tiles);
-                vector<TileKind> draw = tile_bag.remove_random_tiles(curr_move.tiles.size());
-                players[p]->add_tiles(draw);
-                if (curr_move.tiles.size() == hand_size) {
-                    players[p]->add_points(result.points);
-                    players[p]->add_points(EMPTY_HAND_BONUS);
-                    cout << "You gained " << SCORE_COLOR << result.points + EMPTY_HAND_BONUS << rang::style::reset
-                         << " points!" << endl;
-                } else {
-                    players[p]->add_points(result.points);
-                    cout << "You gained " << SCORE_COLOR << result.points << rang::style::reset << " points!" << endl;
-                }
-                cout << "Your current score: " << SCORE_COLOR << players[p]->get_points() << rang::style::reset << endl
-                     << endl;
-                cout << "Press [enter] to continue." << endl;
-                cin.ignore(numeric_limits<streamsize>::max(), '\n');
-            }
-        } else {
-            // if the player isn't human, get_move is called and placed (it doesn't need to be checked
-            // because the returned move is guaranteed to be valid)
-            Move curr_move = players[p]->get_move(board, dictionary);
-            PlaceResult result = board.place(curr_move);
-
-            // the tiles used are removed from the hand and the hand is refilled
-            players[p]->remove_tiles(curr_move.tiles);
-            vector<TileKind> draw = tile_bag.remove_random_tiles(curr_move.tiles.size());
-            players[p]->add_tiles(draw);
-
-            // points are added based on the words created
-            if (curr_move.tiles.size() == hand_size) {
-                players[p]->add_points(result.points + EMPTY_HAND_BONUS);
-                cout << "You gained " << SCORE_COLOR << result.points + EMPTY_HAND_BONUS << rang::style::reset
-                     << " points!" << endl;
-            } else if (curr_move.kind == MoveKind::PLACE) {
-                players[p]->add_points(result.points);
-                cout << "You gained " << SCORE_COLOR << result.points << rang::style::reset << " points!" << endl;
-            }
+        // Human players print the board themselves while asking for their move.
+        if (!player.is_human()) {
+            print_board(game.get_board(), cout);
+        }
 
-            // the generic score output is presented for the computer
-            cout << "Your current score: " << SCORE_COLOR << players[p]->get_points() << rang::style::reset << endl
-                 << endl;
-            cout << "Press [enter] to continue." << endl;
-            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        // If the move cannot be executed, we tell the player and ask them again. A computer
+        // player would only make the same move again, so its illegal move is a bug that ends the game.
+        GameState::TurnResult turn;
+        try {
+            turn = game.apply_move(player.get_move(game.get_board(), dictionary));
+        } catch (const MoveException& e) {
+            if (!player.is_human()) {
+                cout << "Error: " << player.get_name() << " made an illegal move: " << e.what() << endl;
+                return false;
+            }
+            cout << "Error in move: " << e.what() << "\n\n";
+            continue;
         }
 
-        if (players[p]->count_tiles() == 0) {
-            // If the current player has no tiles left, we set the flag so the loop ends next turn.
-            all_players_have_tiles = false;
+        if (turn.move.kind == MoveKind::PLACE) {
+            cout << "You gained " << SCORE_COLOR << turn.points << rang::style::reset << " points!\n";
         }
+        cout << "Your current score: " << SCORE_COLOR << player.get_points() << rang::style::reset << '\n';
+        if (turn.move.kind == MoveKind::PLACE || !player.is_human()) {
+            cout << "\nPress [enter] to continue." << endl;
+        } else {
+            cout << "Press [enter] to confirm." << endl;
+        }
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
     }
+    return true;
 }
 
 // Add players begins the game and sets up the players
@@ -159,55 +95,29 @@ void Scrabble::add_players() {
 
         // simple if statement for making player a computer or human
         if (c == 'y') {
-            newPlayer = make_shared<ComputerPlayer>(name, this->hand_size);
-            non_human_players++;
+            shared_ptr<ComputerPlayer> computer = make_shared<ComputerPlayer>(name, this->hand_size, distribution);
+            computer->set_leave_table(leaves);
+            newPlayer = computer;
         } else {
             newPlayer = make_shared<HumanPlayer>(name, this->hand_size);
         }
 
-        // initialize the player's hand
-        vector<TileKind> draw = tile_bag.remove_random_tiles(hand_size);
-        newPlayer->add_tiles(draw);
-        this->players.push_back(newPlayer);
-        cout << "Player " << i + 1 << ", named \"" << players[i]->get_name() << "\" has been added." << endl;
+        // the game draws the player's hand when they are added
+        game.add_player(newPlayer);
+        cout << "Player " << i + 1 << ", named \"" << newPlayer->get_name() << "\" has been added." << endl;
     }
 }
 
-// Performs final score subtraction. Players lose points for each tile in their
-// hand. The player who cleared their hand receives all the points lost by the
-// other players.
-void Scrabble::final_subtraction(vector<shared_ptr<Player>>& plrs) {
-    // We set up an int to hold how many points the cleared hand player gets
-    // as well as a flag to keep track of if a player has cleared their hand
-    // and an index to save which player it was.
-    int total_lost = 0;
-    bool hand_gone = false;
-    size_t winning_player_index = 0;
-
-    // For each player, we subtract from their points the total value of their hand
-    // and check to see if the player has run out of tiles. We then set the correct
-    // values in lost points and winning index.
-    for (size_t i = 0; i < plrs.size(); ++i) {
-        plrs[i]->subtract_points(plrs[i]->get_hand_value());
-        total_lost += plrs[i]->get_hand_value();
-        if (plrs[i]->count_tiles() == 0) {
-            winning_player_index = i;
-            hand_gone = true;
-        }
-    }
-
-    // If a player has lost their entire hand, we give them all the points
-    // lost by the other players.
-    if (hand_gone) {
-        plrs[winning_player_index]->add_points(total_lost);
-    }
-}
+// Performs final score subtraction. The rules are implemented by GameState.
+void Scrabble::final_subtraction(vector<shared_ptr<Player>>& plrs) { GameState::final_subtraction(plrs); }
 
 // You should not need to change this function.
 void Scrabble::print_result() {
+    const vector<shared_ptr<Player>>& players = game.get_players();
+
     // Determine highest score
     size_t max_points = 0;
-    for (auto player : this->players) {
+    for (auto player : players) {
         if (player->get_points() > max_points) {
             max_points = player->get_points();
         }
@@ -215,7 +125,7 @@ void Scrabble::print_result() {
 
     // Determine the winner(s) indexes
     vector<shared_ptr<Player>> winners;
-    for (auto player : this->players) {
+    for (auto player : players) {
         if (player->get_points() >= max_points) {
             winners.push_back(player);
         }
@@ -234,7 +144,7 @@ void Scrabble::print_result() {
     // Justify all integers printed to have the same amount of character as the high score, left-padding with spaces
     cout << setw(static_cast<uint32_t>(floor(log10(max_points) + 1)));
 
-    for (auto player : this->players) {
+    for (auto player : players) {
         cout << SCORE_COLOR << player->get_points() << rang::style::reset << " | " << PLAYER_NAME_COLOR
              << player->get_name() << rang::style::reset << endl;
     }
@@ -243,7 +153,8 @@ void Scrabble::print_result() {
 // You should not need to change this.
 void Scrabble::main() {
     add_players();
-    game_loop();
-    final_subtraction(this->players);
+    if (!game_loop())
+        return;
+    game.finish();
     print_result();
 }
@@ -6,7 +6,9 @@
 #include "computer_player.h"
 #include "dictionary.h"
 #include "exceptions.h"
+#include "game_state.h"
 #include "human_player.h"
+#include "leave_table.h"
 #include "move.h"
 #include "rang.h"
 #include "scrabble_config.h"
@@ -20,7 +22,7 @@ public:
 
     void main();
 
-    static const size_t EMPTY_HAND_BONUS = 50;
+    static const size_t EMPTY_HAND_BONUS = GameState::EMPTY_HAND_BONUS;
 
     static void final_subtraction(std::vector<std::shared_ptr<Player>>& players);  // public for testing
 
@@ -29,14 +31,13 @@ private:
 
     size_t hand_size;
     size_t minimum_word_length;
-    size_t non_human_players;
-    TileBag tile_bag;
-    Board board;
     Dictionary dictionary;
-    std::vector<std::shared_ptr<Player>> players;
+    std::shared_ptr<const LeaveTable> leaves;  // null when the config names no leave file
+    GameState game;  // must be declared after the dictionary it refers to
+    TileCollection distribution;  // every tile of the full bag, taken before any hand is drawn
 
     void add_players();
-    void game_loop();
+    bool game_loop();
     void print_result();
 };
 
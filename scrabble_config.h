@@ -12,6 +12,7 @@ public:
     std::string board_file_path;
     std::string tile_bag_file_path;
     std::string dictionary_file_path;
+    std::string leave_file_path;  // optional; computer players rank moves by points alone without it
 
     static ScrabbleConfig read(std::string file_path);
 };
@@ -0,0 +1,59 @@
+#ifndef SEARCH_LIMITS_H
+#define SEARCH_LIMITS_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+/*
+Lets another thread stop a search that is in progress. The search notices at its next check and returns the best
+it has found so far.
+*/
+class CancellationToken {
+public:
+    void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+    bool is_cancelled() const { return cancelled.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<bool> cancelled{false};
+};
+
+/*
+When a search has to stop: at a wall-clock deadline, once a token is cancelled, or whichever comes first.
+The default limits never stop a search.
+*/
+struct SearchLimits {
+    typedef std::chrono::steady_clock Clock;
+
+    Clock::time_point deadline = Clock::time_point::max();
+    std::shared_ptr<const CancellationToken> cancellation;
+
+    // Limits that stop a search time_limit from now. A zero time_limit means no deadline.
+    static SearchLimits after(
+            std::chrono::milliseconds time_limit,
+            std::shared_ptr<const CancellationToken> cancellation = nullptr) {
+        SearchLimits limits;
+        if (time_limit.count() > 0)
+            limits.deadline = Clock::now() + time_limit;
+        limits.cancellation = cancellation;
+        return limits;
+    }
+
+    bool has_deadline() const { return deadline != Clock::time_point::max(); }
+
+    bool is_cancelled() const { return cancellation != nullptr && cancellation->is_cancelled(); }
+
+    bool expired() const { return is_cancelled() || (has_deadline() && Clock::now() >= deadline); }
+
+    // The time left before the deadline, or `otherwise` if there is no deadline.
+    std::chrono::milliseconds remaining(std::chrono::milliseconds otherwise) const {
+        if (!has_deadline())
+            return otherwise;
+        Clock::duration left = deadline - Clock::now();
+        if (left <= Clock::duration::zero())
+            return std::chrono::milliseconds(0);
+        return std::chrono::duration_cast<std::chrono::milliseconds>(left);
+    }
+};
+
+#endif
@@ -0,0 +1,408 @@
+#include "computer_player.h"
+#include "exceptions.h"
+#include "game_state.h"
+#include "rng.h"
+#include "scrabble_config.h"
+#include "simulation_player.h"
+#include "thread_pool.h"
+#include "trace.h"
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+struct SelfPlayOptions {
+    string config_path;
+    size_t games = 100;
+    size_t players = 2;
+    std::vector<std::string> kinds{"greedy", "greedy"};  // one entry per player
+    SimulationSettings simulation;
+    EndgameSettings endgame;
+    bool solve_endgames = false;
+    PreEndgameSettings pre_endgame;
+    bool solve_pre_endgames = false;
+    chrono::milliseconds move_time_limit{0};  // zero for no limit
+    size_t threads = 0;  // one per hardware thread
+    uint64_t master_seed = 0;
+    bool has_master_seed = false;
+    bool only_one = false;
+    size_t only_index = 0;
+    string out_path;
+    string games_out_path;
+    string record_path;  // GCG when it ends in .gcg, binary otherwise
+    string trace_path;  // Chrome trace JSON, written at exit
+};
+
+// The outcome of one game, stored by game index so results never depend on thread scheduling.
+struct GameSummary {
+    uint64_t seed = 0;
+    size_t turns = 0;
+    vector<size_t> scores;
+    vector<MoveStats> stats;  // one per player
+    GameRecord record;
+};
+
+void print_usage(const char* program) {
+    cerr << "Usage: " << program << " <configuration file> [--games N] [--players N|KIND,KIND...] [--threads N]"
+         << " [--seed N] [--only INDEX] [--out FILE] [--games-out FILE]"
+         << " [--sim-ms N] [--sim-candidates N] [--sim-plies N] [--endgame-ms N]"
+         << " [--pre-endgame-ms N] [--pre-endgame-tiles N] [--move-ms N]"
+         << " [--record FILE] [--trace FILE]" << endl;
+    cerr << "Player kinds: greedy (highest score), equity (score plus leave), simulation" << endl;
+}
+
+// Reads the command line into options. Returns false if it is malformed.
+bool parse_options(int argc, char** argv, SelfPlayOptions& options) {
+    if (argc < 2) {
+        return false;
+    }
+    options.config_path = argv[1];
+    for (int i = 2; i < argc; i += 2) {
+        if (i + 1 >= argc) {
+            return false;
+        }
+        string flag = argv[i];
+        string value = argv[i + 1];
+        if (flag == "--games") {
+            options.games = stoul(value);
+        } else if (flag == "--players") {
+            // either a number of greedy players or a list of player kinds
+            options.kinds.clear();
+            if (isdigit(value[0])) {
+                options.kinds.resize(stoul(value), "greedy");
+            } else {
+                stringstream ss(value);
+                string kind;
+                while (getline(ss, kind, ',')) {
+                    if (kind != "greedy" && kind != "equity" && kind != "simulation") {
+                        return false;
+                    }
+                    options.kinds.push_back(kind);
+                }
+            }
+            options.players = options.kinds.size();
+        } else if (flag == "--sim-ms") {
+            options.simulation.time_budget = chrono::milliseconds(stoul(value));
+        } else if (flag == "--sim-candidates") {
+            options.simulation.candidates = stoul(value);
+        } else if (flag == "--sim-plies") {
+            options.simulation.plies = stoul(value);
+        } else if (flag == "--endgame-ms") {
+            // 0 leaves the solver off
+            options.endgame.time_limit = chrono::milliseconds(stoul(value));
+            options.solve_endgames = options.endgame.time_limit.count() > 0;
+        } else if (flag == "--pre-endgame-ms") {
+            // 0 leaves the solver off
+            options.pre_endgame.time_limit = chrono::milliseconds(stoul(value));
+            options.solve_pre_endgames = options.pre_endgame.time_limit.count() > 0;
+        } else if (flag == "--pre-endgame-tiles") {
+            options.pre_endgame.max_bag_tiles = stoul(value);
+        } else if (flag == "--move-ms") {
+            options.move_time_limit = chrono::milliseconds(stoul(value));
+        } else if (flag == "--threads") {
+            options.threads = stoul(value);
+        } else if (flag == "--seed") {
+            options.master_seed = stoull(value);
+            options.has_master_seed = true;
+        } else if (flag == "--only") {
+            options.only_one = true;
+            options.only_index = stoul(value);
+        } else if (flag == "--out") {
+            options.out_path = value;
+        } else if (flag == "--games-out") {
+            options.games_out_path = value;
+        } else if (flag == "--record") {
+            options.record_path = value;
+        } else if (flag == "--trace") {
+            options.trace_path = value;
+        } else {
+            return false;
+        }
+    }
+    return options.players > 0;
+}
+
+GameSummary play_game(
+        const SelfPlayOptions& options,
+        const ScrabbleConfig& config,
+        const Dictionary& dictionary,
+        const shared_ptr<const LeaveTable>& leaves,
+        const Board& board,
+        const TileBag& tile_bag,
+        const TileCollection& distribution,
+        size_t index) {
+    TraceSpan span("game", "game");
+    GameSummary summary;
+    summary.seed = Rng::derive_seed(options.master_seed, index);
+
+    TileBag bag(tile_bag);
+    bag.reseed(summary.seed);
+    GameState game(board, bag, dictionary, config.hand_size);
+    for (size_t p = 0; p < options.players; ++p) {
+        string name = "Computer " + to_string(p + 1);
+        shared_ptr<ComputerPlayer> player;
+        if (options.kinds[p] == "simulation") {
+            // games already run in parallel, so each simulation keeps to its own thread
+            SimulationSettings settings = options.simulation;
+            settings.threads = 1;
+            settings.seed = Rng::derive_seed(summary.seed, p);
+            player = make_shared<SimulationPlayer>(name, config.hand_size, distribution, settings);
+            player->set_leave_table(leaves);
+        } else {
+            // the player knows the distribution so that it can work out the opponent's rack in the endgame
+            player = make_shared<ComputerPlayer>(name, config.hand_size, distribution);
+            if (options.kinds[p] == "equity") {
+                player->set_leave_table(leaves);
+            }
+        }
+        if (options.solve_endgames) {
+            player->enable_endgame_solver(options.endgame);
+        }
+        if (options.solve_pre_endgames) {
+            // games already run in parallel
+            PreEndgameSettings settings = options.pre_endgame;
+            settings.threads = 1;
+            player->enable_pre_endgame_solver(settings);
+        }
+        player->set_move_time_limit(options.move_time_limit);
+        game.add_player(player);
+    }
+
+    summary.turns = game.play_to_end();
+    for (size_t p = 0; p < options.players; ++p) {
+        summary.scores.push_back(game.get_players()[p]->get_points());
+        summary.stats.push_back(game.get_stats(p));
+    }
+    if (!options.record_path.empty()) {
+        summary.record = game.get_record();
+    }
+    return summary;
+}
+
+// Writes what each player did to find its moves, added up over every game.
+void write_move_statistics(ostream& out, const vector<GameSummary>& summaries, size_t players) {
+    auto milliseconds = [](chrono::nanoseconds time) { return time.count() / 1e6; };
+    for (size_t p = 0; p < players; ++p) {
+        MoveStats stats;
+        for (const GameSummary& summary : summaries) {
+            stats += summary.stats[p];
+        }
+        string prefix = "player_" + to_string(p + 1) + "_";
+        out << prefix << "moves_asked: " << stats.turns << '\n';
+        out << prefix << "anchors: " << stats.anchors << '\n';
+        out << prefix << "left_part_nodes: " << stats.left_part_nodes << '\n';
+        out << prefix << "extend_right_nodes: " << stats.extend_right_nodes << '\n';
+        out << prefix << "moves_generated: " << stats.moves_generated << '\n';
+        out << prefix << "moves_invalid: " << stats.moves_invalid << '\n';
+        out << prefix << "moves_not_words: " << stats.moves_not_words << '\n';
+        out << prefix << "move_ms: " << milliseconds(stats.turn_time) << '\n';
+        out << prefix << "anchor_ms: " << milliseconds(stats.anchor_time) << '\n';
+        out << prefix << "cross_check_ms: " << milliseconds(stats.cross_check_time) << '\n';
+        out << prefix << "generation_ms: " << milliseconds(stats.generation_time) << '\n';
+        out << prefix << "check_ms: " << milliseconds(stats.check_time) << '\n';
+    }
+}
+
+// Writes the aggregate statistics in the same "key: value" layout as the configuration file.
+void write_statistics(
+        ostream& out,
+        const SelfPlayOptions& options,
+        const vector<GameSummary>& summaries,
+        size_t threads,
+        double seconds) {
+    size_t players = options.players;
+    vector<size_t> wins(players, 0);
+    vector<double> sum(players, 0);
+    vector<double> sum_squares(players, 0);
+    vector<size_t> min_score(players, SIZE_MAX);
+    vector<size_t> max_score(players, 0);
+    size_t ties = 0;
+    size_t turns = 0;
+
+    for (const GameSummary& summary : summaries) {
+        turns += summary.turns;
+        size_t best = 0;
+        for (size_t p = 0; p < players; ++p) {
+            double score = summary.scores[p];
+            sum[p] += score;
+            sum_squares[p] += score * score;
+            min_score[p] = min(min_score[p], summary.scores[p]);
+            max_score[p] = max(max_score[p], summary.scores[p]);
+            best = max(best, summary.scores[p]);
+        }
+
+        // A game with more than one top score is a tie and counts as a win for nobody.
+        size_t winners = 0;
+        size_t winner = 0;
+        for (size_t p = 0; p < players; ++p) {
+            if (summary.scores[p] == best) {
+                winners++;
+                winner = p;
+            }
+        }
+        if (winners == 1) {
+            wins[winner]++;
+        } else {
+            ties++;
+        }
+    }
+
+    double games = summaries.size();
+    out << fixed << setprecision(3);
+    out << "games: " << summaries.size() << '\n';
+    out << "players: " << players << '\n';
+    for (size_t p = 0; p < players; ++p) {
+        out << "player_" << p + 1 << "_kind: " << options.kinds[p] << '\n';
+    }
+    out << "master_seed: " << options.master_seed << '\n';
+    out << "threads: " << threads << '\n';
+    out << "seconds: " << seconds << '\n';
+    out << "games_per_second: " << (seconds > 0 ? games / seconds : 0) << '\n';
+    out << "turns_per_game: " << (games > 0 ? turns / games : 0) << '\n';
+    out << "ties: " << ties << '\n';
+    for (size_t p = 0; p < players; ++p) {
+        double mean = games > 0 ? sum[p] / games : 0;
+        double variance = games > 0 ? sum_squares[p] / games - mean * mean : 0;
+        string prefix = "player_" + to_string(p + 1) + "_";
+        out << prefix << "wins: " << wins[p] << '\n';
+        out << prefix << "win_rate: " << (games > 0 ? wins[p] / games : 0) << '\n';
+        out << prefix << "mean_score: " << mean << '\n';
+        out << prefix << "score_stddev: " << sqrt(max(variance, 0.0)) << '\n';
+        out << prefix << "min_score: " << (games > 0 ? min_score[p] : 0) << '\n';
+        out << prefix << "max_score: " << max_score[p] << '\n';
+    }
+    if (MoveStats::ENABLED) {
+        write_move_statistics(out, summaries, players);
+    }
+    if (players == 2) {
+        out << "mean_spread: " << (games > 0 ? (sum[0] - sum[1]) / games : 0) << '\n';
+    }
+}
+
+// Writes one line per game with its index and seed, so that any game can be replayed with --only.
+void write_games(ostream& out, const SelfPlayOptions& options, const vector<GameSummary>& summaries) {
+    out << "index,seed,turns";
+    for (size_t p = 0; p < options.players; ++p) {
+        out << ",score_" << p + 1;
+    }
+    out << '\n';
+    for (size_t i = 0; i < summaries.size(); ++i) {
+        size_t index = options.only_one ? options.only_index : i;
+        out << index << ',' << summaries[i].seed << ',' << summaries[i].turns;
+        for (size_t score : summaries[i].scores) {
+            out << ',' << score;
+        }
+        out << '\n';
+    }
+}
+
+// Plays a batch of computer games on every core. All games share one dictionary,
+// and each game's bag is seeded from the master seed and the game's index.
+int main(int argc, char** argv) {
+    SelfPlayOptions options;
+    try {
+        if (!parse_options(argc, argv, options)) {
+            print_usage(argv[0]);
+            return 1;
+        }
+    } catch (const logic_error& e) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    try {
+        if (!options.trace_path.empty()) {
+            Trace::enable(options.trace_path);
+        }
+        ScrabbleConfig config = ScrabbleConfig::read(options.config_path);
+        if (!options.has_master_seed) {
+            options.master_seed = config.seed;
+        }
+
+        const Dictionary dictionary = Dictionary::read(config.dictionary_file_path);
+        const Board board = Board::read(config.board_file_path);
+        const TileBag tile_bag = TileBag::read(config.tile_bag_file_path, config.seed);
+        const TileCollection distribution = tile_bag.to_collection();
+        shared_ptr<const LeaveTable> leaves;
+        if (!config.leave_file_path.empty()) {
+            leaves = make_shared<LeaveTable>(LeaveTable::read(config.leave_file_path));
+        }
+
+        size_t count = options.only_one ? 1 : options.games;
+        vector<GameSummary> summaries(count);
+        vector<string> errors(count);  // why a game could not be played to the end, if it could not
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        size_t threads = options.threads == 0 ? ThreadPool::hardware_threads() : options.threads;
+        ThreadPool pool(min(threads, max(count, size_t(1))));
+        pool.parallel_for(count, [&](size_t i) {
+            size_t index = options.only_one ? options.only_index : i;
+            // a player's illegal move ends its game, not the whole run
+            try {
+                summaries[i] = play_game(options, config, dictionary, leaves, board, tile_bag, distribution, index);
+            } catch (const MoveException& e) {
+                errors[i] = "game " + to_string(index) + ": " + e.what();
+            }
+        });
+        chrono::duration<double> seconds = chrono::steady_clock::now() - start;
+
+        bool failed = false;
+        for (const string& error : errors) {
+            if (!error.empty()) {
+                cerr << error << endl;
+                failed = true;
+            }
+        }
+        if (failed) {
+            return 1;
+        }
+
+        if (options.out_path.empty()) {
+            write_statistics(cout, options, summaries, pool.size(), seconds.count());
+        } else {
+            ofstream out(options.out_path);
+            if (!out) {
+                throw FileException("cannot open statistics output file!");
+            }
+            write_statistics(out, options, summaries, pool.size(), seconds.count());
+        }
+
+        if (!options.games_out_path.empty()) {
+            ofstream out(options.games_out_path);
+            if (!out) {
+                throw FileException("cannot open games output file!");
+            }
+            write_games(out, options, summaries);
+        }
+
+        // the games are written in index order, whatever order they finished in
+        if (!options.record_path.empty()) {
+            bool gcg = options.record_path.size() > 4
+                       && options.record_path.compare(options.record_path.size() - 4, 4, ".gcg") == 0;
+            ofstream out(options.record_path, gcg ? ios::out : ios::out | ios::binary);
+            if (!out) {
+                throw FileException("cannot open record output file!");
+            }
+            for (const GameSummary& summary : summaries) {
+                if (gcg) {
+                    summary.record.write_gcg(out, board);
+                } else {
+                    summary.record.write_binary(out);
+                }
+            }
+        }
+    } catch (const FileException& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,285 @@
+#include "analysis.h"
+#include "exceptions.h"
+#include "game_host.h"
+#include "scrabble_config.h"
+#include "thread_pool.h"
+#include "tile_bag.h"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+// A request line longer than this closes the connection, so that a client cannot make the server hold unbounded input.
+static const size_t MAX_REQUEST_BYTES = 1 << 20;
+
+// Answers one request line with one response line.
+typedef function<string(const string& request, chrono::steady_clock::time_point received)> RequestHandler;
+
+struct ServerOptions {
+    string config_path;
+    string socket_path;  // stdin and stdout when empty
+    size_t threads = 0;  // one per hardware thread
+    string service = "analysis";  // or "games"
+    GameHostSettings games;
+};
+
+// A client of the socket. It is closed once its reader and every response still being worked on are done with it.
+struct Connection {
+    int fd;
+    mutex write_mutex;
+
+    explicit Connection(int fd) : fd(fd) {}
+    ~Connection() { close(fd); }
+
+    // Writes a whole line, giving up quietly if the client has gone.
+    void send_line(const string& line) {
+        string data = line + '\n';
+        lock_guard<mutex> lock(write_mutex);
+        for (size_t sent = 0; sent < data.size();) {
+            ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return;
+            sent += n;
+        }
+    }
+};
+
+void print_usage(const char* program) {
+    cerr << "Usage: " << program << " <configuration file> [--socket PATH] [--threads N] [--service analysis|games]"
+         << " [--max-games N] [--bot-threads N]" << endl;
+    cerr << "Answers JSON analysis requests, or hosts games, one request per line, on stdin and stdout or on a Unix"
+         << " socket." << endl;
+}
+
+// Reads the command line into options. Returns false if it is malformed.
+bool parse_options(int argc, char** argv, ServerOptions& options) {
+    if (argc < 2) {
+        return false;
+    }
+    options.config_path = argv[1];
+    for (int i = 2; i < argc; i += 2) {
+        if (i + 1 >= argc) {
+            return false;
+        }
+        string flag = argv[i];
+        string value = argv[i + 1];
+        if (flag == "--socket") {
+            options.socket_path = value;
+        } else if (flag == "--threads") {
+            options.threads = stoul(value);
+        } else if (flag == "--service") {
+            options.service = value;
+        } else if (flag == "--max-games") {
+            options.games.max_games = stoul(value);
+        } else if (flag == "--bot-threads") {
+            options.games.bot_threads = stoul(value);
+        } else {
+            return false;
+        }
+    }
+    return options.service == "analysis" || options.service == "games";
+}
+
+// Answers the requests on stdin until it ends. Responses are written as they are ready, so they may be out of order.
+void serve_stdio(const RequestHandler& handle, ThreadPool& pool) {
+    mutex out_mutex;
+    string line;
+    while (getline(cin, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        chrono::steady_clock::time_point received = chrono::steady_clock::now();
+        pool.submit([&handle, &out_mutex, line, received] {
+            string response = handle(line, received);
+            lock_guard<mutex> lock(out_mutex);
+            cout << response << endl;
+        });
+    }
+    pool.wait();
+}
+
+// Reads the requests of one client and hands them to the pool, until the client closes its end.
+void serve_connection(const RequestHandler& handle, ThreadPool& pool, shared_ptr<Connection> connection) {
+    string pending;
+    char buffer[4096];
+    while (true) {
+        ssize_t n = recv(connection->fd, buffer, sizeof(buffer), 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return;
+        pending.append(buffer, n);
+
+        size_t start = 0;
+        for (size_t end; (end = pending.find('\n', start)) != string::npos; start = end + 1) {
+            string line = pending.substr(start, end - start);
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            if (line.empty())
+                continue;
+            chrono::steady_clock::time_point received = chrono::steady_clock::now();
+            pool.submit([&handle, connection, line, received] {
+                connection->send_line(handle(line, received));
+            });
+        }
+        pending.erase(0, start);
+        if (pending.size() > MAX_REQUEST_BYTES) {
+            connection->send_line("{\"ok\":false,\"error\":\"request too long\"}");
+            return;
+        }
+    }
+}
+
+// The thread reading one client of the socket.
+struct ClientReader {
+    thread reader;
+    weak_ptr<Connection> connection;  // to shut the client out if the server stops first
+    shared_ptr<atomic<bool>> done;  // set by the reader as it returns
+};
+
+// Shuts every client still connected out, waits for their readers and for the requests they handed to the pool.
+static void stop_clients(vector<ClientReader>& clients, ThreadPool& pool) {
+    for (ClientReader& client : clients) {
+        shared_ptr<Connection> connection = client.connection.lock();
+        if (connection != nullptr)
+            shutdown(connection->fd, SHUT_RDWR);
+    }
+    for (ClientReader& client : clients) {
+        client.reader.join();
+    }
+    clients.clear();
+    pool.wait();
+}
+
+/*
+Accepts clients on a Unix socket for as long as the server runs, each read by a thread of its own. Running out of
+file descriptors or memory only holds the next client up; if the socket itself fails, the clients are let go and
+their readers joined before it throws, since they use the handler and the pool.
+*/
+void serve_socket(const RequestHandler& handle, ThreadPool& pool, const string& path) {
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path))
+        throw FileException("socket path too long: " + path);
+    strcpy(address.sun_path, path.c_str());
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0)
+        throw FileException(string("cannot create socket: ") + strerror(errno));
+    unlink(path.c_str());  // a socket left behind by an earlier server
+    if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(listener, 64) < 0)
+        throw FileException("cannot listen on " + path + ": " + strerror(errno));
+    cerr << "listening on " << path << endl;
+
+    vector<ClientReader> clients;
+    while (true) {
+        int client = accept(listener, nullptr, nullptr);
+        if (client < 0) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+                this_thread::sleep_for(chrono::milliseconds(100));
+                continue;
+            }
+            string error = strerror(errno);
+            stop_clients(clients, pool);
+            close(listener);
+            throw FileException("cannot accept a client: " + error);
+        }
+
+        // readers that have finished are joined here, so that only connected clients are kept
+        for (size_t i = 0; i < clients.size();) {
+            if (*clients[i].done) {
+                clients[i].reader.join();
+                clients[i] = move(clients.back());
+                clients.pop_back();
+            } else {
+                ++i;
+            }
+        }
+
+        shared_ptr<Connection> connection = make_shared<Connection>(client);
+        shared_ptr<atomic<bool>> done = make_shared<atomic<bool>>(false);
+        thread reader([&handle, &pool, connection, done] {
+            serve_connection(handle, pool, connection);
+            *done = true;
+        });
+        clients.push_back(ClientReader{move(reader), connection, done});
+    }
+}
+
+/*
+Loads the lexicon, board and bag once and answers analysis requests (see AnalysisService), or hosts games (see
+GameHost), until stdin ends, or for as long as it runs with a socket. Requests are answered on a pool of workers,
+several at a time.
+*/
+int main(int argc, char** argv) {
+    ServerOptions options;
+    try {
+        if (!parse_options(argc, argv, options)) {
+            print_usage(argv[0]);
+            return 1;
+        }
+    } catch (const logic_error& e) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    try {
+        ScrabbleConfig config = ScrabbleConfig::read(options.config_path);
+        const Dictionary dictionary = Dictionary::read(config.dictionary_file_path);
+        const Board board = Board::read(config.board_file_path);
+        const TileBag tile_bag = TileBag::read(config.tile_bag_file_path, config.seed);
+        shared_ptr<const LeaveTable> leaves;
+        if (!config.leave_file_path.empty()) {
+            leaves = make_shared<LeaveTable>(LeaveTable::read(config.leave_file_path));
+        }
+
+        // only the chosen service is made, so that an analysis server does not start the bots' pool
+        unique_ptr<AnalysisService> analysis;
+        unique_ptr<GameHost> host;
+        RequestHandler handle;
+        if (options.service == "games") {
+            options.games.seed = config.seed;
+            host = make_unique<GameHost>(dictionary, board, tile_bag, config.hand_size, leaves, options.games);
+            handle = [&host](const string& request, chrono::steady_clock::time_point received) {
+                return host->handle(request, received);
+            };
+        } else {
+            analysis = make_unique<AnalysisService>(
+                    dictionary, board, tile_bag.to_collection(), config.hand_size, leaves);
+            handle = [&analysis](const string& request, chrono::steady_clock::time_point received) {
+                return analysis->handle(request, received);
+            };
+        }
+
+        ThreadPool pool(options.threads);
+        if (options.socket_path.empty()) {
+            serve_stdio(handle, pool);
+        } else {
+            signal(SIGPIPE, SIG_IGN);
+            serve_socket(handle, pool, options.socket_path);
+        }
+    } catch (const FileException& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,154 @@
+#include "simulation_player.h"
+
+#include "thread_pool.h"
+#include "trace.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+using namespace std;
+
+// the pool is started once for the player rather than for every turn, which would spend the turn's budget on it
+SimulationPlayer::SimulationPlayer(
+        const string& name, size_t hand_size, const TileCollection& distribution, const SimulationSettings& settings)
+        : ComputerPlayer(name, hand_size, distribution), settings(settings) {
+    size_t threads = settings.threads == 0 ? ThreadPool::hardware_threads() : settings.threads;
+    if (this->settings.pool == nullptr && threads > 1)
+        this->settings.pool = make_shared<ThreadPool>(threads);
+}
+
+// picks the candidate with the best average spread over as many playouts as fit in the time budget
+Move SimulationPlayer::get_move_with_stats(const Board& board, const Dictionary& dictionary, MoveStats& stats) const {
+    PhaseTimer timer(stats.turn_time);
+    MoveStats::count(stats.turns);
+
+    // the playouts stop at the end of their budget or at the turn's own limit, whichever comes first
+    SearchLimits limits = turn_limits();
+    chrono::steady_clock::time_point deadline
+            = min(chrono::steady_clock::now() + settings.time_budget, limits.deadline);
+
+    // there is nothing left to simulate once the bag is empty
+    Move endgame_move;
+    if (find_endgame_move(board, dictionary, limits, endgame_move))
+        return endgame_move;
+    if (find_pre_endgame_move(board, dictionary, limits, endgame_move))
+        return endgame_move;
+
+    // with one candidate or none there is nothing to choose between
+    SearchResult result = search(board, dictionary, tiles, settings.candidates, limits, tiles_in_bag(board));
+    stats += result.stats;
+    const vector<ScoredMove>& candidates = result.moves;
+    if (candidates.empty() || (candidates[0].move.kind == MoveKind::PLACE && candidates[0].points == 0))
+        return Move();
+    if (candidates.size() == 1)
+        return candidates[0].move;
+
+    // the unseen tiles are what the opponent's rack and the bag are drawn from
+    TileCollection unseen_collection = unseen_tiles(board);
+    vector<TileKind> unseen;
+    for (TileCollection::const_iterator it = unseen_collection.cbegin(); it != unseen_collection.cend(); it++) {
+        unseen.push_back(*it);
+    }
+
+    vector<double> spread_sum(candidates.size(), 0);
+    vector<size_t> playouts(candidates.size(), 0);
+    mutex results_mutex;
+
+    // playouts are numbered round-robin over the candidates, so every candidate gets
+    // roughly the same number of playouts whenever the budget runs out
+    size_t total = candidates.size() * settings.iterations;
+    atomic<bool> out_of_time(false);
+    auto run_playout = [&](size_t index) {
+        if (out_of_time || chrono::steady_clock::now() >= deadline || limits.is_cancelled()) {
+            out_of_time = true;
+            return;
+        }
+        TraceSpan span("playout", "simulation");
+        size_t candidate = index % candidates.size();
+        Rng random = Rng::derive(Rng::derive_seed(settings.seed, board.get_move_index()), index);
+        double spread = playout(board, dictionary, candidates[candidate], unseen, random);
+
+        lock_guard<mutex> lock(results_mutex);
+        spread_sum[candidate] += spread;
+        playouts[candidate]++;
+    };
+
+    if (settings.pool == nullptr) {
+        for (size_t i = 0; i < total && !out_of_time; i++) {
+            run_playout(i);
+        }
+    } else {
+        settings.pool->parallel_for(total, run_playout);
+    }
+
+    // candidates that never got a playout are judged by their score alone
+    size_t best = 0;
+    double best_value = 0;
+    for (size_t i = 0; i < candidates.size(); i++) {
+        double value = playouts[i] > 0 ? spread_sum[i] / playouts[i] : candidates[i].points;
+        if (i == 0 || value > best_value) {
+            best = i;
+            best_value = value;
+        }
+    }
+    return candidates[best].move;
+}
+
+double SimulationPlayer::playout(
+        const Board& board,
+        const Dictionary& dictionary,
+        const ScoredMove& candidate,
+        const vector<TileKind>& unseen,
+        Rng& random) const {
+    // deal the opponent a rack from the unseen tiles, leaning toward racks its last move suggests; the rest stay in
+    // the bag
+    vector<TileKind> opponent_rack;
+    vector<TileKind> bag;
+    tracker.deal(unseen, leaves.get(), random, opponent_rack, bag);
+    TileCollection racks[2];
+    racks[0] = tiles;
+    for (const TileKind& tile : opponent_rack) {
+        racks[1].add_tile(tile);
+    }
+
+    Board copy(board);
+    double spread = 0;
+    ScoredMove move = candidate;
+    size_t mover = 0;
+
+    // racks[0] is ours and racks[1] the opponent's; the sign turns points into our spread
+    for (size_t ply = 0; ply <= settings.plies; ply++) {
+        if (ply > 0) {
+            vector<ScoredMove> replies = best_moves(copy, dictionary, racks[mover], 1);
+            if (replies.empty()) {
+                mover = 1 - mover;
+                continue;
+            }
+            move = replies[0];
+        }
+
+        copy.place(move.move);
+        for (size_t i = 0; i < move.move.tiles.size(); i++) {
+            racks[mover].remove_tile(move.move.tiles[i]);
+        }
+        // exchanged tiles go back into the bag before the replacements are drawn
+        if (move.move.kind == MoveKind::EXCHANGE) {
+            bag.insert(bag.end(), move.move.tiles.begin(), move.move.tiles.end());
+            random.shuffle(bag.begin(), bag.end());
+        }
+        for (size_t i = 0; i < move.move.tiles.size() && !bag.empty(); i++) {
+            racks[mover].add_tile(bag.back());
+            bag.pop_back();
+        }
+        spread += mover == 0 ? double(move.points) : -double(move.points);
+
+        // going out ends the game: the other rack counts against its owner and for the mover
+        if (racks[mover].count_tiles() == 0) {
+            double left = 2.0 * racks[1 - mover].total_points();
+            spread += mover == 0 ? left : -left;
+            break;
+        }
+        mover = 1 - mover;
+    }
+    return spread;
+}
@@ -0,0 +1,68 @@
+#ifndef SIMULATION_PLAYER_H
+#define SIMULATION_PLAYER_H
+
+#include "computer_player.h"
+#include "rng.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+class ThreadPool;
+
+struct SimulationSettings {
+    // How many of the highest scoring moves are simulated.
+    size_t candidates = 10;
+    // How many replies are played out after each candidate (opponent, then us, and so on).
+    size_t plies = 2;
+    // The most playouts run for each candidate; the time budget usually runs out first.
+    size_t iterations = 100;
+    // Wall-clock time allowed for all the playouts of one turn.
+    std::chrono::milliseconds time_budget = std::chrono::milliseconds(1000);
+    // Threads used for the playouts. Zero means one per hardware thread.
+    size_t threads = 0;
+    /*
+    The pool the playouts run on, which several players may share. When it is null, the player starts one of threads
+    workers that lasts as long as it does, unless that is a single thread, in which case the playouts run on the
+    calling thread.
+    */
+    std::shared_ptr<ThreadPool> pool;
+    uint64_t seed = 0;
+};
+
+/*
+A computer player that chooses between its highest scoring moves by playing each of them out.
+
+For every playout the unseen tiles are dealt into an opponent rack and a bag (see TileTracker::deal), the candidate
+is played, and both sides then make the highest scoring reply for the configured number of plies. The candidate with
+the best average spread (our points minus the opponent's) over its playouts is chosen. Playouts are spread over
+threads, and no new playout is started once the turn's time budget has run out.
+
+Each playout draws from its own Rng stream, derived from the settings' seed, the move index and the playout's number,
+so when the budget is not reached the choice does not depend on the number of threads.
+*/
+class SimulationPlayer : public ComputerPlayer {
+public:
+    SimulationPlayer(
+            const std::string& name,
+            size_t hand_size,
+            const TileCollection& distribution,
+            const SimulationSettings& settings);
+
+    // The playouts' own move generation is not counted in stats, only the search for the candidates.
+    Move get_move_with_stats(const Board& board, const Dictionary& dictionary, MoveStats& stats) const override;
+
+private:
+    SimulationSettings settings;
+
+    /*
+    Plays one candidate out against a random opponent rack and returns the resulting spread.
+    */
+    double playout(
+            const Board& board,
+            const Dictionary& dictionary,
+            const ScoredMove& candidate,
+            const std::vector<TileKind>& unseen,
+            Rng& random) const;
+};
+
+#endif
@@ -0,0 +1,84 @@
+#include "thread_pool.h"
+
+#include <atomic>
+
+using namespace std;
+
+ThreadPool::ThreadPool(size_t threads) {
+    if (threads == 0) {
+        threads = hardware_threads();
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        workers.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    wait();
+    {
+        lock_guard<mutex> lock(jobs_mutex);
+        stopping = true;
+    }
+    job_available.notify_all();
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i].join();
+    }
+}
+
+void ThreadPool::submit(function<void()> job) {
+    {
+        lock_guard<mutex> lock(jobs_mutex);
+        jobs.push_back(move(job));
+    }
+    job_available.notify_one();
+}
+
+void ThreadPool::wait() {
+    unique_lock<mutex> lock(jobs_mutex);
+    all_done.wait(lock, [this] { return jobs.empty() && running == 0; });
+}
+
+void ThreadPool::parallel_for(size_t count, const function<void(size_t)>& job) {
+    // Each worker keeps claiming the next index until they have all been handed out.
+    atomic<size_t> next(0);
+    size_t batches = min(count, workers.size());
+    for (size_t i = 0; i < batches; ++i) {
+        submit([&next, &job, count] {
+            for (size_t index = next++; index < count; index = next++) {
+                job(index);
+            }
+        });
+    }
+    wait();
+}
+
+size_t ThreadPool::hardware_threads() {
+    size_t threads = thread::hardware_concurrency();
+    return threads > 0 ? threads : 1;
+}
+
+void ThreadPool::work() {
+    while (true) {
+        function<void()> job;
+        {
+            unique_lock<mutex> lock(jobs_mutex);
+            job_available.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (jobs.empty()) {
+                return;
+            }
+            job = move(jobs.front());
+            jobs.pop_front();
+            running++;
+        }
+
+        job();
+
+        {
+            lock_guard<mutex> lock(jobs_mutex);
+            running--;
+            if (jobs.empty() && running == 0) {
+                all_done.notify_all();
+            }
+        }
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+A fixed set of worker threads that run submitted jobs in the order they were submitted.
+
+Jobs must not throw; anything they need to report should be written into storage owned by the caller.
+*/
+class ThreadPool {
+public:
+    // Starts `threads` workers. Zero means one per hardware thread.
+    explicit ThreadPool(size_t threads = 0);
+
+    // Waits for all submitted jobs to finish before stopping the workers.
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> job);
+
+    // Blocks until every submitted job has finished.
+    void wait();
+
+    /*
+    Calls job(i) for every i in [0, count) on the workers and returns once all calls have finished.
+    Indices are handed out one at a time, so uneven jobs still keep every worker busy.
+    Must not be called from inside a job running on the same pool.
+    */
+    void parallel_for(size_t count, const std::function<void(size_t)>& job);
+
+    size_t size() const { return workers.size(); }
+
+    // The number of hardware threads, or 1 if it cannot be determined.
+    static size_t hardware_threads();
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::mutex jobs_mutex;
+    std::condition_variable job_available;
+    std::condition_variable all_done;
+    size_t running = 0;
+    bool stopping = false;
+
+    void work();
+};
+
+#endif
@@ -2,12 +2,12 @@
 
 #include "exceptions.h"
 #include "tile_collection.h"
+#include "trace.h"
 #include <fstream>
-#include <iostream>
 
 using namespace std;
 
-TileBag TileBag::read(std::string file_path, uint32_t seed) {
+TileBag TileBag::read(std::string file_path, uint64_t seed) {
     TileBag bag(seed);
 
     std::ifstream file(file_path);
@@ -19,8 +19,8 @@ TileBag TileBag::read(std::string file_path, uint32_t seed) {
     unsigned short points;
     size_t count;
 
-    while (!file.eof()) {
-        file >> letter >> points >> count;
+    // A trailing newline must not add the last kind a second time, so we stop as soon as a line fails to read.
+    while (file >> letter >> points >> count) {
         TileKind kind(letter, points);
         bag.add_tiles(kind, count);
         bag.kinds.emplace(letter, kind);
@@ -30,23 +30,40 @@ TileBag TileBag::read(std::string file_path, uint32_t seed) {
 }
 
 std::vector<TileKind> TileBag::remove_random_tiles(size_t count) {
-    size_t total_count = this->count_tiles();
+    TraceSpan span("draw", "bag");
+    // We can never draw more tiles than are left in the bag.
+    if (count > this->tiles.size()) {
+        count = this->tiles.size();
+    }
 
+    // Each draw moves a uniformly chosen tile to the end of the array and takes it from there.
     std::vector<TileKind> result;
+    result.reserve(count);
     for (size_t i = 0; i < count; ++i) {
-        size_t index = std::uniform_int_distribution<size_t>(0, total_count - 1)(this->random);
-        for (TileMap::iterator it = this->tiles.begin(); it != this->tiles.end(); ++it) {
-            if (index < it->second) {
-                it->second -= 1;
-                total_count -= 1;
-                result.push_back(it->first);
-                break;
-            }
-            index -= it->second;
-        }
+        size_t last = this->tiles.size() - 1;
+        size_t index = this->random.below(last + 1);
+        std::swap(this->tiles[index], this->tiles[last]);
+        result.push_back(this->tiles[last]);
+        this->tiles.pop_back();
     }
 
     return result;
 }
 
+void TileBag::add_tile(TileKind kind) { this->tiles.push_back(kind); }
+
+void TileBag::add_tiles(TileKind kind, size_t n) { this->tiles.insert(this->tiles.end(), n, kind); }
+
+size_t TileBag::count_tiles() const { return this->tiles.size(); }
+
+TileCollection TileBag::to_collection() const {
+    TileCollection collection;
+    for (const TileKind& tile : this->tiles) {
+        collection.add_tile(tile);
+    }
+    return collection;
+}
+
+void TileBag::reseed(uint64_t seed) { this->random = Rng(seed); }
+
 const unordered_map<char, TileKind>& TileBag::get_kinds() const { return this->kinds; }
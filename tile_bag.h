@@ -1,27 +1,52 @@
 #ifndef TILE_BAG_H
 #define TILE_BAG_H
 
+#include "rng.h"
 #include "tile_collection.h"
 #include "tile_kind.h"
-#include <random>
+#include <cstdint>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
-class TileBag : public TileCollection {
+/*
+The tiles that have not been drawn yet, kept as a flat array in no particular order.
+
+Drawing a tile swaps a uniformly chosen tile to the end of the array and removes it there (one step of a
+Fisher-Yates shuffle), and returning a tile appends it, so both take constant time. Every tile left in the bag is
+equally likely to be drawn next, whatever order the tiles are stored in.
+*/
+class TileBag {
 public:
-    static TileBag read(std::string file_path, uint32_t seed);
+    static TileBag read(std::string file_path, uint64_t seed);
 
     std::vector<TileKind> remove_random_tiles(size_t count);  // Used for testing
 
+    // Puts tiles back into the bag, as after an exchange.
+    void add_tile(TileKind kind);
+    void add_tiles(TileKind kind, size_t n);
+
+    size_t count_tiles() const;
+
+    // Returns the tiles in the bag as a collection, which is the tile distribution for a bag that was just read.
+    TileCollection to_collection() const;
+
+    /*
+    Restarts the random number generator, so that copies of one bag can be used for differently seeded games.
+    Batches of games seed each bag with Rng::derive_seed(master seed, game index), so that any game of a batch can be
+    replayed on its own.
+    */
+    void reseed(uint64_t seed);
+
     const std::unordered_map<char, TileKind>& get_kinds() const;
 
 protected:
-    TileBag(uint32_t seed) : random(seed) {}
+    TileBag(uint64_t seed) : random(seed) {}
 
 private:
+    std::vector<TileKind> tiles;
     std::unordered_map<char, TileKind> kinds;
-    std::mt19937 random;
+    Rng random;
 };
 
 #endif
@@ -85,7 +85,7 @@ TileCollection::const_iterator::self_type TileCollection::const_iterator::operat
         map_itr++;
         repeat_count = 0;
     }
-    while (map_itr->second == 0)
+    while (map_itr != map_end && map_itr->second == 0)
         map_itr++;
     return *this;
 }
@@ -97,6 +97,6 @@ TileCollection::const_iterator::self_type TileCollection::const_iterator::operat
     return i;
 }
 
-TileCollection::const_iterator TileCollection::cbegin() const { return const_iterator(tiles.cbegin()); }
+TileCollection::const_iterator TileCollection::cbegin() const { return const_iterator(tiles.cbegin(), tiles.cend()); }
 
-TileCollection::const_iterator TileCollection::cend() const { return const_iterator(tiles.cend()); }
+TileCollection::const_iterator TileCollection::cend() const { return const_iterator(tiles.cend(), tiles.cend()); }
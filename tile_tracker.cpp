@@ -0,0 +1,94 @@
+#include "tile_tracker.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+TileTracker::TileTracker(const TileCollection& distribution, size_t hand_size) : hand_size(hand_size) {
+    // the iterator repeats each letter once per copy, so a new kind starts whenever the letter changes
+    for (TileCollection::const_iterator it = distribution.cbegin(); it != distribution.cend(); it++) {
+        if (kinds.empty() || !(kinds.back() == *it)) {
+            slots[uint8_t(it->letter) & 127] = kinds.size();
+            kinds.push_back(*it);
+            counts.push_back(0);
+        }
+        counts.back()++;
+        pool_count++;
+    }
+}
+
+void TileTracker::observe_move(const Move& move, bool own_move) {
+    moves++;
+
+    // placed tiles can be seen by everyone; exchanged tiles go back into the bag and stay unseen
+    if (move.kind == MoveKind::PLACE) {
+        for (const TileKind& tile : move.tiles) {
+            counts[slots[uint8_t(tile.letter) & 127]]--;
+            pool_count--;
+        }
+    }
+
+    if (own_move)
+        return;
+
+    // a pass says nothing about which tiles the opponent likes
+    knows_opponent_leave = move.kind != MoveKind::PASS && move.tiles.size() < hand_size;
+    opponent_kept = hand_size - move.tiles.size();
+}
+
+TileCollection TileTracker::unseen(const TileCollection& rack) const {
+    TileCollection unseen;
+    for (size_t i = 0; i < kinds.size(); i++) {
+        size_t count = counts[i] - min(counts[i], rack.count_tiles(kinds[i]));
+        if (count > 0)
+            unseen.add_tiles(kinds[i], count);
+    }
+    return unseen;
+}
+
+void TileTracker::deal(
+        const vector<TileKind>& unseen,
+        const LeaveTable* leaves,
+        Rng& random,
+        vector<TileKind>& opponent_rack,
+        vector<TileKind>& bag) const {
+    bag = unseen;
+    opponent_rack.clear();
+    size_t rack_size = min(hand_size, bag.size());
+
+    if (leaves != nullptr && knows_opponent_leave && opponent_kept < rack_size) {
+        // each proposal is a random set of kept tiles, moved to the end of its own copy of the bag
+        vector<vector<TileKind>> proposals(INFERENCE_PROPOSALS, bag);
+        vector<double> values(INFERENCE_PROPOSALS);
+        for (size_t p = 0; p < INFERENCE_PROPOSALS; p++) {
+            vector<TileKind>& proposal = proposals[p];
+            TileCollection kept;
+            for (size_t i = 0; i < opponent_kept; i++) {
+                size_t last = proposal.size() - 1 - i;
+                swap(proposal[random.below(last + 1)], proposal[last]);
+                kept.add_tile(proposal[last]);
+            }
+            values[p] = leaves->value(kept);
+        }
+
+        // weights are relative to the best proposal so that exp() cannot overflow
+        double best_value = *max_element(values.begin(), values.end());
+        vector<double> weights(INFERENCE_PROPOSALS);
+        for (size_t p = 0; p < INFERENCE_PROPOSALS; p++) {
+            weights[p] = exp((values[p] - best_value) / INFERENCE_TEMPERATURE);
+        }
+        size_t chosen = random.pick(weights);
+
+        bag = proposals[chosen];
+        opponent_rack.assign(bag.end() - opponent_kept, bag.end());
+        bag.erase(bag.end() - opponent_kept, bag.end());
+    }
+
+    // the rest of the opponent's rack was drawn at random
+    random.shuffle(bag.begin(), bag.end());
+    while (opponent_rack.size() < rack_size) {
+        opponent_rack.push_back(bag.back());
+        bag.pop_back();
+    }
+}
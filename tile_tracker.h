@@ -0,0 +1,73 @@
+#ifndef TILE_TRACKER_H
+#define TILE_TRACKER_H
+
+#include "leave_table.h"
+#include "move.h"
+#include "rng.h"
+#include "tile_collection.h"
+#include "tile_kind.h"
+#include <cstdint>
+#include <vector>
+
+/*
+Keeps track of the tiles a player has not seen, from that player's point of view.
+
+The tracker starts from the full distribution and takes away the tiles of every move it is told about, so the pool
+is always the distribution minus the board; the tiles a player has not seen are that pool minus its own rack. Counts
+are kept per letter, so each update is a handful of array operations instead of a scan of the board.
+
+It also remembers how many tiles the opponent kept on its last turn, so that opponent racks can be sampled with a
+bias toward keeping a good leave: players who rank moves by equity keep the tiles that are worth keeping, and racks
+where the kept tiles make a poor leave are less likely. This assumes a two player game.
+*/
+class TileTracker {
+public:
+    // How many possible sets of kept tiles are weighed against each other for each sampled rack.
+    static const size_t INFERENCE_PROPOSALS = 16;
+    // Leave values are divided by this before weighting; a smaller value trusts the opponent's play more.
+    static constexpr double INFERENCE_TEMPERATURE = 8.0;
+
+    TileTracker() {}
+    TileTracker(const TileCollection& distribution, size_t hand_size);
+
+    /*
+    Updates the pool after a move by any player. For exchanges by other players only the number of tiles is used,
+    as the tiles themselves are hidden.
+    */
+    void observe_move(const Move& move, bool own_move);
+
+    // The number of moves observed, which matches the board's move index when no move was missed.
+    size_t moves_observed() const { return moves; }
+
+    // The tiles that are not on the board, including the ones in the player's own rack.
+    size_t count_pool() const { return pool_count; }
+
+    // Returns the tiles the player has not seen: the pool minus rack.
+    TileCollection unseen(const TileCollection& rack) const;
+
+    /*
+    Splits unseen into a rack for the opponent and a shuffled bag. Without a leave table, or when the opponent's
+    last move tells us nothing, the opponent's rack is uniformly random. Otherwise the tiles it kept are chosen from
+    several random proposals with weights that grow with the value of the leave they would have made.
+    */
+    void deal(
+            const std::vector<TileKind>& unseen,
+            const LeaveTable* leaves,
+            Rng& random,
+            std::vector<TileKind>& opponent_rack,
+            std::vector<TileKind>& bag) const;
+
+private:
+    size_t hand_size = 0;
+    std::vector<TileKind> kinds;  // one of each letter in the distribution
+    std::vector<size_t> counts;   // how many tiles of each kind are not on the board
+    uint8_t slots[128] = {};      // the index into kinds and counts for each letter
+    size_t pool_count = 0;
+    size_t moves = 0;
+
+    // how many tiles the opponent kept after its last move, if it was a move we can learn from
+    bool knows_opponent_leave = false;
+    size_t opponent_kept = 0;
+};
+
+#endif
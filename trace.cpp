@@ -0,0 +1,121 @@
+#include "trace.h"
+
+#include "exceptions.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+atomic<bool> Trace::on(false);
+
+struct TraceEvent {
+    const char* name;
+    const char* category;
+    uint64_t start;
+    uint64_t duration;
+};
+
+/*
+The spans of one thread. Only that thread writes to it; it grows up to the capacity and then span n goes into slot
+n % capacity. When the thread finishes the buffer is handed on to the next new thread, so that threads that come and
+go, like the pools of players that are made and dropped, do not leave a buffer each behind them.
+*/
+struct ThreadBuffer {
+    size_t id;
+    vector<TraceEvent> events;
+    uint64_t recorded = 0;
+};
+
+// Gives the buffer of a thread back when the thread finishes.
+struct BufferHolder {
+    shared_ptr<ThreadBuffer> buffer;
+
+    ~BufferHolder();
+};
+
+static mutex buffers_mutex;
+// kept after their threads finish, so that they can be written at exit
+static vector<shared_ptr<ThreadBuffer>> buffers;
+static vector<shared_ptr<ThreadBuffer>> free_buffers;
+static size_t capacity = Trace::DEFAULT_CAPACITY;
+static ofstream trace_file;  // opened by enable, so that a bad path fails then rather than at exit
+static chrono::steady_clock::time_point epoch;
+
+static thread_local BufferHolder holder;
+
+BufferHolder::~BufferHolder() {
+    if (buffer) {
+        lock_guard<mutex> lock(buffers_mutex);
+        free_buffers.push_back(buffer);
+    }
+}
+
+static ThreadBuffer& buffer_of_this_thread() {
+    if (!holder.buffer) {
+        lock_guard<mutex> lock(buffers_mutex);
+        if (!free_buffers.empty()) {
+            holder.buffer = free_buffers.back();
+            free_buffers.pop_back();
+        } else {
+            holder.buffer = make_shared<ThreadBuffer>();
+            holder.buffer->id = buffers.size() + 1;
+            buffers.push_back(holder.buffer);
+        }
+    }
+    return *holder.buffer;
+}
+
+static void write_at_exit() { Trace::write(trace_file); }
+
+void Trace::enable(const string& file_path, size_t spans_per_thread) {
+    if (enabled())
+        return;
+    trace_file.open(file_path);
+    if (!trace_file)
+        throw FileException("cannot open trace output file " + file_path);
+    capacity = spans_per_thread > 0 ? spans_per_thread : 1;
+    epoch = chrono::steady_clock::now();
+    atexit(write_at_exit);
+    on.store(true, memory_order_release);
+}
+
+uint64_t Trace::now() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - epoch).count();
+}
+
+void Trace::record(const char* name, const char* category, uint64_t start, uint64_t end) {
+    ThreadBuffer& buffer = buffer_of_this_thread();
+    TraceEvent event{name, category, start, end - start};
+    if (buffer.events.size() < capacity) {
+        buffer.events.push_back(event);
+    } else {
+        buffer.events[buffer.recorded % capacity] = event;
+    }
+    buffer.recorded++;
+}
+
+// Timestamps are in microseconds, the unit of the format, with the nanoseconds kept as decimals.
+void Trace::write(ostream& out) {
+    lock_guard<mutex> lock(buffers_mutex);
+    uint64_t dropped = 0;
+    bool first = true;
+    out << "{\"traceEvents\": [\n";
+    out << fixed << setprecision(3);
+    for (const shared_ptr<ThreadBuffer>& buffer : buffers) {
+        uint64_t kept = min<uint64_t>(buffer->recorded, buffer->events.size());
+        dropped += buffer->recorded - kept;
+        for (uint64_t n = buffer->recorded - kept; n < buffer->recorded; n++) {
+            const TraceEvent& event = buffer->events[n % buffer->events.size()];
+            out << (first ? "" : ",\n") << "{\"name\": \"" << event.name << "\", \"cat\": \"" << event.category
+                << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << buffer->id << ", \"ts\": " << event.start / 1e3
+                << ", \"dur\": " << event.duration / 1e3 << "}";
+            first = false;
+        }
+    }
+    out << "\n],\n\"displayTimeUnit\": \"ns\",\n\"otherData\": {\"dropped_spans\": " << dropped << "}}\n";
+}
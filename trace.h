@@ -0,0 +1,79 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/*
+An optional timeline of what every thread is doing, written in the Chrome trace event format so that it can be opened
+in chrome://tracing or ui.perfetto.dev. Each thread records its spans into a ring buffer of its own, so recording
+takes no lock and a long run keeps the most recent spans of every thread. While tracing is off a span costs one acquire
+load, which is a plain load on x86.
+
+Span names and categories are stored as pointers, so they must be string literals.
+*/
+class Trace {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 16;
+
+    /*
+    Starts recording, keeping up to capacity spans per thread, and writes the trace to file_path at exit. Throws
+    FileException if file_path cannot be written.
+    */
+    static void enable(const std::string& file_path, size_t capacity = DEFAULT_CAPACITY);
+
+    // Pairs with the release in enable, so that a thread that sees tracing on also sees its epoch and capacity.
+    static bool enabled() { return on.load(std::memory_order_acquire); }
+
+    // Nanoseconds since tracing was enabled.
+    static uint64_t now();
+
+    // Records a span on the calling thread's timeline.
+    static void record(const char* name, const char* category, uint64_t start, uint64_t end);
+
+    // Writes every kept span as Chrome trace JSON. No thread may be recording while this runs.
+    static void write(std::ostream& out);
+
+private:
+    static std::atomic<bool> on;
+};
+
+// Records the time from its construction to its destruction as a span, when tracing is on.
+class TraceSpan {
+public:
+    TraceSpan(const char* name, const char* category) : name(name), category(category) { begin(); }
+
+    ~TraceSpan() { end(); }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    // Ends the span and starts another with the same name, to split a long loop into batches.
+    void restart() {
+        end();
+        begin();
+    }
+
+private:
+    const char* name;
+    const char* category;
+    bool active = false;
+    uint64_t start = 0;
+
+    void begin() {
+        active = Trace::enabled();
+        if (active)
+            start = Trace::now();
+    }
+
+    void end() {
+        if (active)
+            Trace::record(name, category, start, Trace::now());
+        active = false;
+    }
+};
+
+#endif